@@ -0,0 +1,3 @@
+g++ -DNDEBUG -O4 -Wall -oCONVBOOK.EXE ../eleeye/pregen.cpp ../eleeye/position.cpp ../eleeye/genmoves.cpp ../eleeye/book.cpp CONVBOOK.CPP
+g++ -DNDEBUG -O4 -Wall -oFOLDBOOK.EXE ../eleeye/pregen.cpp ../eleeye/position.cpp ../eleeye/genmoves.cpp ../eleeye/book.cpp FOLDBOOK.CPP
+g++ -DNDEBUG -O4 -Wall -oPGN2BOOK.EXE ../eleeye/pregen.cpp ../eleeye/position.cpp ../eleeye/genmoves.cpp ../eleeye/book.cpp ../cchess/cchess.cpp ../cchess/pgnfile.cpp PGN2BOOK.CPP -lpthread
\ No newline at end of file
@@ -1 +1 @@
-g++ -DNDEBUG -O4 -Wall -ldl -oUCCILEAG.EXE ../base/pipe.cpp ../base/wsockbas.cpp ../codec/base64/base64.cpp ../eleeye/pregen.cpp ../eleeye/position.cpp ../eleeye/genmoves.cpp ../cchess/cchess.cpp ../cchess/pgnfile.cpp uccileag.cpp
\ No newline at end of file
+g++ -DNDEBUG -O4 -Wall -ldl -oUCCILEAG.EXE ../base/pipe.cpp ../base/wsockbas.cpp ../codec/base64/base64.cpp ../eleeye/pregen.cpp ../eleeye/position.cpp ../eleeye/genmoves.cpp ../eleeye/book.cpp ../cchess/cchess.cpp ../cchess/pgnfile.cpp uccileag.cpp
\ No newline at end of file
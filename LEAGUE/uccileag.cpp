@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../base/wsockbas.h"
 #include "../codec/base64/base64.h"
 #include "../eleeye/position.h"
+#include "../eleeye/book.h"
 #include "../cchess/cchess.h"
 #include "../cchess/ecco.h"
 #include "../cchess/pgnfile.h"
@@ -122,6 +123,8 @@ static struct {
   bool bPromotion;
   char szEvent[MAX_CHAR], szSite[MAX_CHAR];
   char szRobinFens[MAX_ROBIN][MAX_CHAR];
+  char szLearnBook[MAX_CHAR];     // ¼ԾֽĿֿ⣬ձʾ¼
+  int nLearnPlies;                // ÿ¼ͷĲ
   EccoApiStruct EccoApi;
 } League;
 
@@ -729,6 +732,7 @@ struct GameStruct {
   void QuitEngine(void); // ˳
   void ResumeGame(void); // ϴι
   bool EndGame(int nRobin, int nRound, int nGame);   // ֹһ
+  void LearnBook(void);     // ѶԾֽ׷ӵֿѧϰ¼
   void TerminateGame(void); // жһ
 };
 
@@ -1091,12 +1095,42 @@ void GameStruct::ResumeGame(void) {
     if (nResult == 0) {
       RunEngine(); // δô˼һ
     } else {
-      // Ѿôֹ
+      // Ѿôֹ棬¼Ծֽ
       QuitEngine();
+      LearnBook();
     }
   }
 }
 
+/* ѶԾֽ׷ӵֿѧϰ¼("book.h")ʤŷȨؼ1ŷȨؼ1岻¼
+ * ֻڶԾʵʽʱ¼ӽļֲָظ¼
+ */
+void GameStruct::LearnBook(void) {
+  BookJournalStruct bjs[MAX_MOVE_LEN];
+  PositionStruct pos;
+  int i, mv, nLen;
+
+  if (League.szLearnBook[0] == '\0' || nResult == 2) {
+    return;
+  }
+  pos = lppgn->posStart;
+  nLen = 0;
+  for (i = 1; i <= MIN(lppgn->nMaxMove, League.nLearnPlies); i ++) {
+    mv = lppgn->wmvMoveTable[i];
+    MakeBookJournal(bjs[nLen], pos, mv, (nResult == 1) == (pos.sdPlayer == 0) ? 1 : -1);
+    if (!pos.LegalMove(mv) || !pos.MakeMove(mv)) {
+      break;
+    }
+    if (pos.LastMove().CptDrw > 0) {
+      pos.SetIrrev();
+    }
+    nLen ++;
+  }
+  if (nLen > 0 && !AppendBookJournal(League.szLearnBook, bjs, nLen)) {
+    printf("޷д뿪ֿ\"%s\"ѧϰ¼\n", League.szLearnBook);
+  }
+}
+
 const struct ResultStruct {
   int nHomeWin, nHomeDraw, nHomeLoss, nHomeScore, nAwayWin, nAwayDraw, nAwayLoss, nAwayScore;
   double dfWHome;
@@ -1239,6 +1273,8 @@ int main(void) {
   League.nStandardCpuTime = 1000;
   League.nNameLen = nEngineFileLen = 8; // ƺļС
   League.bPromotion = false;
+  League.szLearnBook[0] = '\0';
+  League.nLearnPlies = 20;
   League.szEvent[0] = League.szSite[0] = '\0';
   Live.szHost[0] = Live.szPath[0] = Live.szPassword[0] = Live.szCounter[0] = '\0';
   Live.szProxyHost[0] = Live.szProxyUser[0] = Live.szProxyPassword[0] = '\0';
@@ -1282,6 +1318,10 @@ int main(void) {
       } else if (StrEqv(lp, "On")) {
         League.bPromotion = true;
       }
+    } else if (StrEqvSkip(lp, "LearnBook=")) {
+      strcpy(League.szLearnBook, lp);
+    } else if (StrEqvSkip(lp, "LearnPlies=")) {
+      League.nLearnPlies = Str2Digit(lp, 1, 200);
     // 3.8¹ܣ趨ʼ
     } else if (StrEqvSkip(lp, "Position=")) {
       if (nRobinFen < MAX_ROBIN) {
@@ -1359,6 +1399,9 @@ int main(void) {
   if (League.bPromotion) {
     printf("򣺡(ʿ)()ɱ()\n");
   }
+  if (League.szLearnBook[0] != '\0') {
+    printf("ѧϰ¼%s (ÿ %d )\n", League.szLearnBook, League.nLearnPlies);
+  }
   printf("ģUCCIģ 3.8\n\n");
   printf("棺\n\n");
   printf("   д ");
@@ -18,9 +18,14 @@
   typedef signed   __int8   int8_t;  // c
   typedef unsigned __int8  uint8_t;  // uc
   #define FORMAT_I64 "I64"
+  #include <xmmintrin.h>
 #else
   #include <stdint.h>
-  #define FORMAT_I64 "ll"
+  #ifdef __LP64__
+    #define FORMAT_I64 "l"
+  #else
+    #define FORMAT_I64 "ll"
+  #endif
 #endif
 
 #define __ASSERT(a) assert(a)
@@ -82,6 +87,14 @@ inline int PopCnt32(uint32_t dw) {
   return (n >> 16) + (n & 0x0000ffff);
 }
 
+inline void Prefetch(const void *lp) {
+#ifdef _MSC_VER
+  _mm_prefetch((const char *) lp, _MM_HINT_T0);
+#else
+  __builtin_prefetch(lp);
+#endif
+}
+
 #ifdef __ANDROID__
 
 inline int64_t GetTime() {
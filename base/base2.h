@@ -1,7 +1,11 @@
 #ifdef _WIN32
   #include <windows.h>
 #else
+  #include <fcntl.h>
   #include <pthread.h>
+  #include <stdio.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
   #include <stdlib.h>
   #include <unistd.h>
 #endif
@@ -31,7 +35,108 @@ inline void GetSelfExe(char *szDst) {
 
 inline void StartThread(void *ThreadEntry(void *), void *lpParameter) {
   DWORD dwThreadId;
-  CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) ThreadEntry, (LPVOID) lpParameter, 0, &dwThreadId);
+  CloseHandle(CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) ThreadEntry, (LPVOID) lpParameter, 0, &dwThreadId));
+}
+
+// Եȴ߳
+struct ThreadHandleStruct {
+  HANDLE hThread;
+  void Start(void *ThreadEntry(void *), void *lpParameter) {
+    DWORD dwThreadId;
+    hThread = CreateThread(NULL, 0, (LPTHREAD_START_ROUTINE) ThreadEntry, (LPVOID) lpParameter, 0, &dwThreadId);
+  }
+  void Join(void) {
+    WaitForSingleObject(hThread, INFINITE);
+    CloseHandle(hThread);
+  }
+};
+
+// Զλ¼ȴ¼̹߳𣬲ռô
+struct EventStruct {
+  HANDLE hEvent;
+  void Init(void) {
+    hEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+  }
+  void Destroy(void) {
+    CloseHandle(hEvent);
+  }
+  void Set(void) {
+    SetEvent(hEvent);
+  }
+  void Wait(void) {
+    WaitForSingleObject(hEvent, INFINITE);
+  }
+};
+
+inline void MemFence(void) {
+  MemoryBarrier();
+}
+
+inline int GetCpuNum(void) {
+  SYSTEM_INFO si;
+  GetSystemInfo(&si);
+  return si.dwNumberOfProcessors;
+}
+
+// ڴ(ҳ벢)ʹôҳ棬ûȨʱʹͨҳ
+inline void *LargeAlloc(size_t nSize) {
+  void *lp;
+  size_t nLargePage;
+  nLargePage = GetLargePageMinimum();
+  if (nLargePage != 0 && nSize % nLargePage == 0) {
+    lp = VirtualAlloc(NULL, nSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if (lp != NULL) {
+      return lp;
+    }
+  }
+  return VirtualAlloc(NULL, nSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+inline void LargeFree(void *lp, size_t nSize) {
+  VirtualFree(lp, 0, MEM_RELEASE);
+}
+
+// ӳļ(дʱƣӳڴĸĶдļ)ļڻΪʱNULL
+inline void *MapFile(const char *szFileName, size_t &nSize) {
+  HANDLE hFile, hMap;
+  LARGE_INTEGER liSize;
+  void *lp;
+  hFile = CreateFile(szFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+  if (hFile == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  if (!GetFileSizeEx(hFile, &liSize) || liSize.QuadPart == 0) {
+    CloseHandle(hFile);
+    return NULL;
+  }
+  nSize = (size_t) liSize.QuadPart;
+  hMap = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  CloseHandle(hFile);
+  if (hMap == NULL) {
+    return NULL;
+  }
+  lp = MapViewOfFile(hMap, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(hMap);
+  return lp;
+}
+
+inline void UnmapFile(void *lp, size_t nSize) {
+  UnmapViewOfFile(lp);
+}
+
+inline bool RenameFile(const char *szSrc, const char *szDst) {
+  return MoveFileEx(szSrc, szDst, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+// ȡļĴС޸ʱ䣬ļʱ"false"
+inline bool GetFileStamp(const char *szFileName, int64_t &llSize, int64_t &llTime) {
+  WIN32_FILE_ATTRIBUTE_DATA wfad;
+  if (!GetFileAttributesEx(szFileName, GetFileExInfoStandard, &wfad)) {
+    return false;
+  }
+  llSize = ((int64_t) wfad.nFileSizeHigh << 32) | wfad.nFileSizeLow;
+  llTime = ((int64_t) wfad.ftLastWriteTime.dwHighDateTime << 32) | wfad.ftLastWriteTime.dwLowDateTime;
+  return true;
 }
 
 #else
@@ -55,9 +160,123 @@ inline void StartThread(void *ThreadEntry(void *), void *lpParameter) {
   pthread_attr_t pthread_attr;
   pthread_attr_init(&pthread_attr);
   pthread_attr_setscope(&pthread_attr, PTHREAD_SCOPE_SYSTEM);
+  pthread_attr_setdetachstate(&pthread_attr, PTHREAD_CREATE_DETACHED);
   pthread_create(&pthread, &pthread_attr, ThreadEntry, lpParameter);
 }
 
+// Եȴ߳
+struct ThreadHandleStruct {
+  pthread_t pthread;
+  void Start(void *ThreadEntry(void *), void *lpParameter) {
+    pthread_attr_t pthread_attr;
+    pthread_attr_init(&pthread_attr);
+    pthread_attr_setscope(&pthread_attr, PTHREAD_SCOPE_SYSTEM);
+    pthread_create(&pthread, &pthread_attr, ThreadEntry, lpParameter);
+  }
+  void Join(void) {
+    pthread_join(pthread, NULL);
+  }
+};
+
+// Զλ¼ȴ¼̹߳𣬲ռô
+struct EventStruct {
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool bSignaled;
+  void Init(void) {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+    bSignaled = false;
+  }
+  void Destroy(void) {
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&mutex);
+  }
+  void Set(void) {
+    pthread_mutex_lock(&mutex);
+    bSignaled = true;
+    pthread_cond_signal(&cond);
+    pthread_mutex_unlock(&mutex);
+  }
+  void Wait(void) {
+    pthread_mutex_lock(&mutex);
+    while (!bSignaled) {
+      pthread_cond_wait(&cond, &mutex);
+    }
+    bSignaled = false;
+    pthread_mutex_unlock(&mutex);
+  }
+};
+
+inline void MemFence(void) {
+  __sync_synchronize();
+}
+
+inline int GetCpuNum(void) {
+  return (int) sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+// ڴ(ҳ벢)ʹԤĴҳ棬ʹ͸ҳ
+inline void *LargeAlloc(size_t nSize) {
+  void *lp;
+#ifdef MAP_HUGETLB
+  lp = mmap(NULL, nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (lp != MAP_FAILED) {
+    return lp;
+  }
+#endif
+  lp = mmap(NULL, nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (lp == MAP_FAILED) {
+    return NULL;
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(lp, nSize, MADV_HUGEPAGE);
+#endif
+  return lp;
+}
+
+inline void LargeFree(void *lp, size_t nSize) {
+  munmap(lp, nSize);
+}
+
+// ӳļ(дʱƣӳڴĸĶдļ)ļڻΪʱNULL
+inline void *MapFile(const char *szFileName, size_t &nSize) {
+  int fd;
+  struct stat st;
+  void *lp;
+  fd = open(szFileName, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return NULL;
+  }
+  nSize = (size_t) st.st_size;
+  lp = mmap(NULL, nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  return lp == MAP_FAILED ? NULL : lp;
+}
+
+inline void UnmapFile(void *lp, size_t nSize) {
+  munmap(lp, nSize);
+}
+
+inline bool RenameFile(const char *szSrc, const char *szDst) {
+  return rename(szSrc, szDst) == 0;
+}
+
+// ȡļĴС޸ʱ䣬ļʱ"false"
+inline bool GetFileStamp(const char *szFileName, int64_t &llSize, int64_t &llTime) {
+  struct stat st;
+  if (stat(szFileName, &st) != 0) {
+    return false;
+  }
+  llSize = (int64_t) st.st_size;
+  llTime = (int64_t) st.st_mtime;
+  return true;
+}
+
 #endif
 
 inline void LocatePath(char *szDst, const char *szSrc) {
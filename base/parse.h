@@ -128,4 +128,13 @@ inline int Str2Digit(const char *sz, int nMin, int nMax) {
   }
 }
 
+inline int64_t Str2Digit64(const char *sz, int64_t llMin, int64_t llMax) {
+  int64_t llRet;
+  if (sscanf(sz, "%" FORMAT_I64 "d", &llRet) > 0) {
+    return MIN(MAX(llRet, llMin), llMax);
+  } else {
+    return llMin;
+  }
+}
+
 #endif
@@ -38,31 +38,36 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 extern "C" __declspec(dllexport) LPCSTR WINAPI CchessVersion(VOID);
 extern "C" __declspec(dllexport) VOID WINAPI CchessInit(BOOL bTraditional);
 extern "C" __declspec(dllexport) VOID WINAPI CchessPromotion(BOOL bPromotion);
-extern "C" __declspec(dllexport) VOID WINAPI CchessAddPiece(PositionStruct *lppos, LONG sq, LONG pc, BOOL bDel);
-extern "C" __declspec(dllexport) BOOL WINAPI CchessCanPromote(PositionStruct *lppos, LONG sq);
-extern "C" __declspec(dllexport) BOOL WINAPI CchessTryMove(PositionStruct *lppos, LPLONG lpStatus, LONG mv);
-extern "C" __declspec(dllexport) VOID WINAPI CchessUndoMove(PositionStruct *lppos);
-extern "C" __declspec(dllexport) BOOL WINAPI CchessTryNull(PositionStruct *lppos);
-extern "C" __declspec(dllexport) VOID WINAPI CchessUndoNull(PositionStruct *lppos);
-extern "C" __declspec(dllexport) LONG WINAPI CchessGenMoves(PositionStruct *lppos, LPLONG lpmv);
-extern "C" __declspec(dllexport) VOID WINAPI CchessSetIrrev(PositionStruct *lppos);
-extern "C" __declspec(dllexport) VOID WINAPI CchessClearBoard(PositionStruct *lppos);
-extern "C" __declspec(dllexport) VOID WINAPI CchessBoardMirror(PositionStruct *lppos);
-extern "C" __declspec(dllexport) VOID WINAPI CchessExchangeSide(PositionStruct *lppos);
-extern "C" __declspec(dllexport) VOID WINAPI CchessFlipBoard(PositionStruct *lppos);
-extern "C" __declspec(dllexport) LPSTR WINAPI CchessBoardText(const PositionStruct *lppos, BOOL bAnsi);
-extern "C" __declspec(dllexport) LPSTR WINAPI CchessBoard2Fen(const PositionStruct *lppos);
-extern "C" __declspec(dllexport) VOID WINAPI CchessFen2Board(PositionStruct *lppos, LPCSTR szFen);
+extern "C" __declspec(dllexport) VOID WINAPI CchessAddPiece(FixedPositionStruct *lppos, LONG sq, LONG pc, BOOL bDel);
+extern "C" __declspec(dllexport) BOOL WINAPI CchessCanPromote(FixedPositionStruct *lppos, LONG sq);
+extern "C" __declspec(dllexport) BOOL WINAPI CchessTryMove(FixedPositionStruct *lppos, LPLONG lpStatus, LONG mv);
+extern "C" __declspec(dllexport) VOID WINAPI CchessUndoMove(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) BOOL WINAPI CchessTryNull(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) VOID WINAPI CchessUndoNull(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) LONG WINAPI CchessGenMoves(FixedPositionStruct *lppos, LPLONG lpmv);
+extern "C" __declspec(dllexport) VOID WINAPI CchessSetIrrev(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) VOID WINAPI CchessClearBoard(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) VOID WINAPI CchessBoardMirror(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) VOID WINAPI CchessExchangeSide(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) VOID WINAPI CchessFlipBoard(FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) LPSTR WINAPI CchessBoardText(const FixedPositionStruct *lppos, BOOL bAnsi);
+extern "C" __declspec(dllexport) LPSTR WINAPI CchessBoard2Fen(const FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) VOID WINAPI CchessFen2Board(FixedPositionStruct *lppos, LPCSTR szFen);
 extern "C" __declspec(dllexport) LPSTR WINAPI CchessFenMirror(LPCSTR szFenSrc);
 extern "C" __declspec(dllexport) LONG WINAPI CchessFileMirror(LONG dwFileStr);
 extern "C" __declspec(dllexport) LONG WINAPI CchessChin2File(LONGLONG qwChinStr);
 extern "C" __declspec(dllexport) LONGLONG WINAPI CchessFile2Chin(LONG dwFileStr, LONG sd);
-extern "C" __declspec(dllexport) LONG WINAPI CchessFile2Move(LONG dwFileStr, const PositionStruct *lppos);
-extern "C" __declspec(dllexport) LONG WINAPI CchessMove2File(LONG mv, const PositionStruct *lppos);
+extern "C" __declspec(dllexport) LONG WINAPI CchessFile2Move(LONG dwFileStr, const FixedPositionStruct *lppos);
+extern "C" __declspec(dllexport) LONG WINAPI CchessMove2File(LONG mv, const FixedPositionStruct *lppos);
 
 // İ汾ţڡʦʹáڹ򡱹ܿԿ
 static const char *const cszCchessVersion = "Chinese Chess Driver 3.21";
 
+/* ߴǹ̶ʽľ("position.h"е"FixedPositionStruct")
+ * ӿںȰתṹдı˾תȥ
+ */
+static PositionStruct posDll;
+
 LPCSTR WINAPI CchessVersion(VOID) {
   return cszCchessVersion;
 }
@@ -76,51 +81,65 @@ VOID WINAPI CchessPromotion(BOOL bPromotion) {
   PreEval.bPromotion = bPromotion != FALSE;
 }
 
-VOID WINAPI CchessAddPiece(PositionStruct *lppos, LONG sq, LONG pc, BOOL bDel) {
-  lppos->AddPiece(sq, pc, bDel != FALSE);
+VOID WINAPI CchessAddPiece(FixedPositionStruct *lppos, LONG sq, LONG pc, BOOL bDel) {
+  posDll.FromFixed(*lppos);
+  posDll.AddPiece(sq, pc, bDel != FALSE);
+  posDll.ToFixed(*lppos);
 }
 
-BOOL WINAPI CchessCanPromote(PositionStruct *lppos, LONG sq) {
+BOOL WINAPI CchessCanPromote(FixedPositionStruct *lppos, LONG sq) {
   int pt;
-  if (PreEval.bPromotion && lppos->CanPromote() && CAN_PROMOTE(sq)) {
-    pt = PIECE_TYPE(lppos->ucpcSquares[sq]);
+  posDll.FromFixed(*lppos);
+  if (PreEval.bPromotion && posDll.CanPromote() && CAN_PROMOTE(sq)) {
+    pt = PIECE_TYPE(posDll.ucpcSquares[sq]);
     return pt == ADVISOR_TYPE || pt == BISHOP_TYPE;
   }
   return FALSE;
 }
 
-BOOL WINAPI CchessTryMove(PositionStruct *lppos, LPLONG lpStatus, LONG mv) {
-  return TryMove(*lppos, *(int *) lpStatus, mv);
+BOOL WINAPI CchessTryMove(FixedPositionStruct *lppos, LPLONG lpStatus, LONG mv) {
+  bool bSuccess;
+  posDll.FromFixed(*lppos);
+  bSuccess = TryMove(posDll, *(int *) lpStatus, mv);
+  posDll.ToFixed(*lppos);
+  return bSuccess;
 }
 
-VOID WINAPI CchessUndoMove(PositionStruct *lppos) {
-  lppos->UndoMakeMove();
+VOID WINAPI CchessUndoMove(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  posDll.UndoMakeMove();
+  posDll.ToFixed(*lppos);
 }
 
 // ִСšùĿǰڡ
-BOOL WINAPI CchessTryNull(PositionStruct *lppos) {
-  if (lppos->LastMove().ChkChs > 0) {
+BOOL WINAPI CchessTryNull(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  if (posDll.LastMove().ChkChs > 0) {
     return FALSE;
   } else {
-    lppos->NullMove();
+    posDll.NullMove();
+    posDll.ToFixed(*lppos);
     return TRUE;
   }
 }
 
 // šùĿǰڡ
-VOID WINAPI CchessUndoNull(PositionStruct *lppos) {
-  lppos->UndoNullMove();
+VOID WINAPI CchessUndoNull(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  posDll.UndoNullMove();
+  posDll.ToFixed(*lppos);
 }
 
 // ȫŷ
-LONG WINAPI CchessGenMoves(PositionStruct *lppos, LPLONG lpmv) {
+LONG WINAPI CchessGenMoves(FixedPositionStruct *lppos, LPLONG lpmv) {
   int i, nTotal, nLegal;
   MoveStruct mvs[MAX_GEN_MOVES];
-  nTotal = lppos->GenAllMoves(mvs);
+  posDll.FromFixed(*lppos);
+  nTotal = posDll.GenAllMoves(mvs);
   nLegal = 0;
   for (i = 0; i < nTotal; i ++) {
-    if (lppos->MakeMove(mvs[i].wmv)) {
-      lppos->UndoMakeMove();
+    if (posDll.MakeMove(mvs[i].wmv)) {
+      posDll.UndoMakeMove();
       lpmv[nLegal] = mvs[i].wmv;
       nLegal ++;
     }
@@ -128,44 +147,60 @@ LONG WINAPI CchessGenMoves(PositionStruct *lppos, LPLONG lpmv) {
   return nLegal;
 }
 
-VOID WINAPI CchessSetIrrev(PositionStruct *lppos) {
-  lppos->SetIrrev();
+VOID WINAPI CchessSetIrrev(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  posDll.SetIrrev();
+  posDll.ToFixed(*lppos);
 }
 
-VOID WINAPI CchessClearBoard(PositionStruct *lppos) {
-  lppos->ClearBoard();
+VOID WINAPI CchessClearBoard(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  posDll.ClearBoard();
+  posDll.ToFixed(*lppos);
 }
 
-VOID WINAPI CchessStartBoard(PositionStruct *lppos) {
-  lppos->FromFen(cszStartFen);
+VOID WINAPI CchessStartBoard(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  posDll.FromFen(cszStartFen);
+  posDll.ToFixed(*lppos);
 }
 
-VOID WINAPI CchessBoardMirror(PositionStruct *lppos) {
-  lppos->Mirror();
+VOID WINAPI CchessBoardMirror(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  posDll.Mirror();
+  posDll.ToFixed(*lppos);
 }
 
-VOID WINAPI CchessExchangeSide(PositionStruct *lppos) {
-  ExchangeSide(*lppos);
+VOID WINAPI CchessExchangeSide(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  ExchangeSide(posDll);
+  posDll.ToFixed(*lppos);
 }
 
-VOID WINAPI CchessFlipBoard(PositionStruct *lppos) {
-  FlipBoard(*lppos);
+VOID WINAPI CchessFlipBoard(FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  FlipBoard(posDll);
+  posDll.ToFixed(*lppos);
 }
 
-LPSTR WINAPI CchessBoardText(const PositionStruct *lppos, BOOL bAnsi) {
+LPSTR WINAPI CchessBoardText(const FixedPositionStruct *lppos, BOOL bAnsi) {
   static char szBoard[2048];
-  BoardText(szBoard, *lppos, bAnsi != FALSE);
+  posDll.FromFixed(*lppos);
+  BoardText(szBoard, posDll, bAnsi != FALSE);
   return szBoard;
 }
 
-LPSTR WINAPI CchessBoard2Fen(const PositionStruct *lppos) {
+LPSTR WINAPI CchessBoard2Fen(const FixedPositionStruct *lppos) {
   static char szFen[128];
-  lppos->ToFen(szFen);
+  posDll.FromFixed(*lppos);
+  posDll.ToFen(szFen);
   return szFen;
 }
 
-VOID WINAPI CchessFen2Board(PositionStruct *lppos, LPCSTR szFen) {
-  lppos->FromFen(szFen);
+VOID WINAPI CchessFen2Board(FixedPositionStruct *lppos, LPCSTR szFen) {
+  posDll.FromFixed(*lppos);
+  posDll.FromFen(szFen);
+  posDll.ToFixed(*lppos);
 }
 
 LPSTR WINAPI CchessFenMirror(LPCSTR szFenSrc) {
@@ -186,12 +221,14 @@ LONGLONG WINAPI CchessFile2Chin(LONG dwFileStr, LONG sd) {
   return File2Chin(dwFileStr, sd);
 }
 
-LONG WINAPI CchessFile2Move(LONG dwFileStr, const PositionStruct *lppos) {
-  return File2Move(dwFileStr, *lppos);
+LONG WINAPI CchessFile2Move(LONG dwFileStr, const FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  return File2Move(dwFileStr, posDll);
 }
 
-LONG WINAPI CchessMove2File(LONG mv, const PositionStruct *lppos) {
-  return Move2File(mv, *lppos);
+LONG WINAPI CchessMove2File(LONG mv, const FixedPositionStruct *lppos) {
+  posDll.FromFixed(*lppos);
+  return Move2File(mv, posDll);
 }
 
 #endif
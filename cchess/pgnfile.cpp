@@ -44,7 +44,7 @@ void PgnFileStruct::Init(void) {
   }  
 }
 
-PgnFileStruct::~PgnFileStruct(void) {
+void PgnFileStruct::DelComments(void) {
   int i;
   for (i = 0; i < MAX_MOVE_LEN; i ++) {
     if (szCommentTable[i] != NULL) {
@@ -41,12 +41,15 @@ struct PgnFileStruct {
   char *szCommentTable[MAX_MOVE_LEN];
 
   void Init(void);
+  void DelComments(void);
   PgnFileStruct(void) {
     Init();
   };
-  ~PgnFileStruct(void);
-  void Reset(void) {
-    this->~PgnFileStruct();
+  ~PgnFileStruct(void) {
+    DelComments();
+  }
+  void Reset(void) { // ܵ"posStart"Ļعбᱻͷ
+    DelComments();
     Init();
   }
   bool Read(const char *szFileName, bool bNoAdvert = false);
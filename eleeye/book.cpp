@@ -20,87 +20,912 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include <stdlib.h>
+#include <string.h>
+#include "../base/base2.h"
+#include "pregen.h"
 #include "position.h"
 #include "book.h"
 
-int GetBookMoves(const PositionStruct &pos, const char *szBookFile, BookStruct *lpbks) {
-  BookFileStruct BookFile;
-  PositionStruct posScan;
-  BookStruct bk;
-  int nScan, nLow, nHigh, nPtr;
-  int i, j, nMoves;
-  // ӿֿỵ̂¼裺
+static const char *const cszBookMagic = "EEBOOK02";
 
-  // 1. 򿪿ֿ⣬ʧܣ򷵻ؿֵ
-  if (!BookFile.Open(szBookFile)) {
-    return 0;
+// ŷͱ(08099)תյ90е
+inline int BOOK_SQ_INDEX(int sq) {
+  return (RANK_Y(sq) - RANK_TOP) * 9 + FILE_X(sq) - FILE_LEFT;
+}
+
+inline int BOOK_INDEX_SQ(int nIndex) {
+  return COORD_XY(nIndex % 9 + FILE_LEFT, nIndex / 9 + RANK_TOP);
+}
+
+inline int BOOK_MOVE_CODE(int mv) {
+  return BOOK_SQ_INDEX(SRC(mv)) * 90 + BOOK_SQ_INDEX(DST(mv));
+}
+
+inline int BOOK_CODE_MOVE(int nCode) {
+  return MOVE(BOOK_INDEX_SQ(nCode / 90), BOOK_INDEX_SQ(nCode % 90));
+}
+
+const int BOOK_CODE_BITS = 13;
+
+// λд룬λǰ
+struct BitWriterStruct {
+  uint8_t *lpuc;
+  int nBits;
+  void Init(uint8_t *lpucArg) {
+    lpuc = lpucArg;
+    nBits = 0;
+  }
+  void PutBit(int nBit) {
+    if ((nBits & 7) == 0) {
+      lpuc[nBits >> 3] = 0;
+    }
+    lpuc[nBits >> 3] |= nBit << (nBits & 7);
+    nBits ++;
+  }
+  void PutBits(uint64_t qw, int nLen) {
+    int i;
+    for (i = 0; i < nLen; i ++) {
+      PutBit((int) (qw >> i) & 1);
+    }
+  }
+  void PutUnary(uint64_t qw) { // "qw"0ټһ1
+    for (; qw > 0; qw --) {
+      PutBit(0);
+    }
+    PutBit(1);
+  }
+  void PutGamma(uint32_t dw) { // "dw"0
+    int nLen;
+    nLen = 0;
+    while ((dw >> nLen) > 1) {
+      nLen ++;
+    }
+    PutUnary(nLen);
+    PutBits(dw, nLen);
+  }
+  void PutRice(uint64_t qw, int nShift) {
+    PutUnary(qw >> nShift);
+    PutBits(qw, nShift);
   }
+  int Bytes(void) const {
+    return (nBits + 7) >> 3;
+  }
+};
 
-  // 2. òҷ棻
-  posScan = pos;
-  for (nScan = 0; nScan < 2; nScan ++) {
-    nPtr = nLow = 0;
-    nHigh = BookFile.nLen - 1;
-    while (nLow <= nHigh) {
-      nPtr = (nLow + nHigh) / 2;
-      BookFile.Read(bk, nPtr);
-      if (BOOK_POS_CMP(bk, posScan) < 0) {
-        nLow = nPtr + 1;          
-      } else if (BOOK_POS_CMP(bk, posScan) > 0) {
-        nHigh = nPtr - 1;
+// λΧʱĶ1𻵵ļҲѭ
+struct BitReaderStruct {
+  const uint8_t *lpuc, *lpucEnd;
+  uint64_t qwBits;
+  int GetBit(void) {
+    int nBit;
+    nBit = (lpuc + (qwBits >> 3) < lpucEnd ? (lpuc[qwBits >> 3] >> (qwBits & 7)) & 1 : 1);
+    qwBits ++;
+    return nBit;
+  }
+  uint64_t GetBits(int nLen) {
+    int i;
+    uint64_t qw;
+    qw = 0;
+    for (i = 0; i < nLen; i ++) {
+      qw |= (uint64_t) GetBit() << i;
+    }
+    return qw;
+  }
+  uint64_t GetUnary(void) {
+    uint64_t qw;
+    qw = 0;
+    while (GetBit() == 0) {
+      qw ++;
+    }
+    return qw;
+  }
+  uint32_t GetGamma(void) {
+    int nLen;
+    nLen = (int) GetUnary();
+    if (nLen > 31) {
+      return 0;
+    }
+    return (uint32_t) ((1u << nLen) | GetBits(nLen));
+  }
+  uint64_t GetRice(int nShift) {
+    uint64_t qw;
+    qw = GetUnary() << nShift;
+    return qw | GetBits(nShift);
+  }
+};
+
+inline uint64_t BOOK_KEY(uint32_t dwLock1, uint32_t dwLock0) {
+  return ((uint64_t) dwLock1 << 32) | dwLock0;
+}
+
+inline uint64_t BOOK_KEY(const PositionStruct &pos) {
+  return BOOK_KEY(pos.zobr.dwLock1, pos.zobr.dwLock0);
+}
+
+inline uint64_t BOOK_KEY(const BookIndexStruct &bi) {
+  return BOOK_KEY(bi.dwLock1, bi.dwLock0);
+}
+
+bool BookWriterStruct::Open(const char *szBookFile) {
+  if (strlen(szBookFile) + 5 > PATH_MAX_CHAR) {
+    return false;
+  }
+  strcpy(szFileName, szBookFile);
+  sprintf(szTempFile, "%s.tmp", szBookFile);
+  fp = fopen(szTempFile, "wb");
+  if (fp == NULL) {
+    return false;
+  }
+  memset(&bh, 0, sizeof(BookHeaderStruct));
+  memcpy(bh.szMagic, cszBookMagic, 8);
+  bh.dwZobristKey = PreGen.zobrPlayer.dwKey;
+  bh.dwZobristLock0 = PreGen.zobrPlayer.dwLock0;
+  bh.dwZobristLock1 = PreGen.zobrPlayer.dwLock1;
+  bh.qwIndexOffset = sizeof(BookHeaderStruct);
+  bError = fwrite(&bh, sizeof(BookHeaderStruct), 1, fp) != 1;
+  nIndexMax = 1024;
+  lpbis = new BookIndexStruct[nIndexMax];
+  lpqwKeys = new uint64_t[BOOK_BLOCK_LEN];
+  lpnMoves = new int[BOOK_BLOCK_LEN];
+  lpwCodes = new uint16_t[BOOK_BLOCK_LEN * MAX_GEN_MOVES];
+  lpwvls = new uint16_t[BOOK_BLOCK_LEN * MAX_GEN_MOVES];
+  lpucBlock = new uint8_t[BOOK_BLOCK_LEN * MAX_GEN_MOVES * 8 + 1024];
+  dwLock1 = dwLock0 = 0;
+  nMoves = nPositions = nCodes = 0;
+  return true;
+}
+
+void BookWriterStruct::Add(uint32_t dwZobristLock1, uint32_t dwZobristLock0, int mv, int vl) {
+  uint64_t qwKey, qwLastKey;
+  int i, nCode;
+  qwKey = BOOK_KEY(dwZobristLock1, dwZobristLock0);
+  qwLastKey = BOOK_KEY(dwLock1, dwLock0);
+  if (nMoves > 0 && qwKey != qwLastKey) {
+    if (qwKey < qwLastKey) {
+      bError = true; // ûа˳
+      return;
+    }
+    EndPosition();
+  }
+  // ͬһظŷҪϲȨأֵΪıڽʱһŷ
+  nCode = BOOK_MOVE_CODE(mv);
+  for (i = nCodes - nMoves; i < nCodes; i ++) {
+    if (lpwCodes[i] == nCode) {
+      lpwvls[i] = MIN(lpwvls[i] + MAX(vl, 0), 65535);
+      return;
+    }
+  }
+  if (nMoves == MAX_GEN_MOVES) {
+    return;
+  }
+  dwLock1 = dwZobristLock1;
+  dwLock0 = dwZobristLock0;
+  lpwCodes[nCodes] = nCode;
+  lpwvls[nCodes] = MIN(MAX(vl, 0), 65535);
+  nCodes ++;
+  nMoves ++;
+}
+
+void BookWriterStruct::EndPosition(void) {
+  lpqwKeys[nPositions] = BOOK_KEY(dwLock1, dwLock0);
+  lpnMoves[nPositions] = nMoves;
+  nPositions ++;
+  bh.dwPositions ++;
+  bh.dwRecords += nMoves;
+  nMoves = 0;
+  if (nPositions == BOOK_BLOCK_LEN) {
+    FlushBlock();
+  }
+}
+
+void BookWriterStruct::FlushBlock(void) {
+  BitWriterStruct BitWriter;
+  BookIndexStruct *lpbisNew;
+  uint64_t qwSum;
+  int i, j, k, nShift, nFirst;
+
+  if (nPositions == 0) {
+    return;
+  }
+  // 1. ¼ϡ
+  if ((int) bh.dwBlocks == nIndexMax) {
+    lpbisNew = new BookIndexStruct[nIndexMax * 2];
+    memcpy(lpbisNew, lpbis, nIndexMax * sizeof(BookIndexStruct));
+    delete[] lpbis;
+    lpbis = lpbisNew;
+    nIndexMax *= 2;
+  }
+  lpbis[bh.dwBlocks].dwLock1 = (uint32_t) (lpqwKeys[0] >> 32);
+  lpbis[bh.dwBlocks].dwLock0 = (uint32_t) lpqwKeys[0];
+  lpbis[bh.dwBlocks].qwOffset = bh.qwIndexOffset;
+  bh.dwBlocks ++;
+
+  // 2. ZobristֵƽֵȷRiceĲ
+  qwSum = 0;
+  for (i = 1; i < nPositions; i ++) {
+    qwSum += lpqwKeys[i] - lpqwKeys[i - 1] - 1;
+  }
+  nShift = 0;
+  if (nPositions > 1) {
+    qwSum /= nPositions - 1;
+    while ((qwSum >> nShift) > 1) {
+      nShift ++;
+    }
+  }
+  lpucBlock[0] = nPositions;
+  lpucBlock[1] = nShift;
+
+  // 3. 룬ÿŷȰ
+  BitWriter.Init(lpucBlock + 2);
+  nFirst = 0;
+  for (i = 0; i < nPositions; i ++) {
+    for (j = nFirst + 1; j < nFirst + lpnMoves[i]; j ++) {
+      for (k = j; k > nFirst && lpwCodes[k - 1] > lpwCodes[k]; k --) {
+        SWAP(lpwCodes[k - 1], lpwCodes[k]);
+        SWAP(lpwvls[k - 1], lpwvls[k]);
+      }
+    }
+    if (i > 0) {
+      BitWriter.PutRice(lpqwKeys[i] - lpqwKeys[i - 1] - 1, nShift);
+    }
+    BitWriter.PutGamma(lpnMoves[i]);
+    for (j = nFirst; j < nFirst + lpnMoves[i]; j ++) {
+      if (j == nFirst) {
+        BitWriter.PutBits(lpwCodes[j], BOOK_CODE_BITS);
       } else {
+        BitWriter.PutGamma(lpwCodes[j] - lpwCodes[j - 1]);
+      }
+      BitWriter.PutGamma(lpwvls[j] + 1);
+    }
+    nFirst += lpnMoves[i];
+  }
+  j = BitWriter.Bytes() + 2;
+  if (fwrite(lpucBlock, j, 1, fp) != 1) {
+    bError = true;
+  }
+  bh.qwIndexOffset += j;
+  nPositions = nCodes = 0;
+}
+
+bool BookWriterStruct::Close(void) {
+  uint8_t ucPad[8];
+  int nPad;
+  if (nMoves > 0) {
+    EndPosition();
+  }
+  FlushBlock();
+  // ϡ8ֽڶ룬ӳ䵽ڴֱӷ
+  nPad = (int) (-bh.qwIndexOffset & 7);
+  memset(ucPad, 0, 8);
+  if (nPad > 0 && fwrite(ucPad, nPad, 1, fp) != 1) {
+    bError = true;
+  }
+  bh.qwIndexOffset += nPad;
+  if (bh.dwBlocks > 0 && fwrite(lpbis, sizeof(BookIndexStruct), bh.dwBlocks, fp) != bh.dwBlocks) {
+    bError = true;
+  }
+  fseek(fp, 0, SEEK_SET);
+  if (fwrite(&bh, sizeof(BookHeaderStruct), 1, fp) != 1) {
+    bError = true;
+  }
+  if (fclose(fp) != 0) {
+    bError = true;
+  }
+  delete[] lpbis;
+  delete[] lpqwKeys;
+  delete[] lpnMoves;
+  delete[] lpwCodes;
+  delete[] lpwvls;
+  delete[] lpucBlock;
+  if (bError || !RenameFile(szTempFile, szFileName)) {
+    remove(szTempFile);
+    return false;
+  }
+  return true;
+}
+
+// ҵһZobristС"dwLock"ļ¼ֻ"nLow""nHigh - 1"֮
+static int BookLowerBound(const BookStruct *lpbks, int nLow, int nHigh, uint32_t dwLock) {
+  int nPtr;
+  while (nLow < nHigh) {
+    nPtr = (nLow + nHigh) / 2;
+    if (lpbks[nPtr].dwZobristLock < dwLock) {
+      nLow = nPtr + 1;
+    } else {
+      nHigh = nPtr;
+    }
+  }
+  return nLow;
+}
+
+// ҵһZobrist"qwKey"Ŀ飬ֻ"nLow""nHigh - 1"֮
+static int BookUpperBound(const BookIndexStruct *lpbis, int nLow, int nHigh, uint64_t qwKey) {
+  int nPtr;
+  while (nLow < nHigh) {
+    nPtr = (nLow + nHigh) / 2;
+    if (BOOK_KEY(lpbis[nPtr]) <= qwKey) {
+      nLow = nPtr + 1;
+    } else {
+      nHigh = nPtr;
+    }
+  }
+  return nLow;
+}
+
+static int CompareRecord(const BookRecordStruct &br1, const BookRecordStruct &br2) {
+  return br1.dwLock1 < br2.dwLock1 ? -1 : br1.dwLock1 > br2.dwLock1 ? 1 :
+      br1.dwLock0 < br2.dwLock0 ? -1 : br1.dwLock0 > br2.dwLock0 ? 1 : br1.mv - br2.mv;
+}
+
+static int CompareRecordPtr(const void *lp1, const void *lp2) {
+  return CompareRecord(*(const BookRecordStruct *) lp1, *(const BookRecordStruct *) lp2);
+}
+
+bool GetJournalFile(char *szJournalFile, const char *szBookFile) {
+  char *lpExt;
+  if (strlen(szBookFile) + 5 > PATH_MAX_CHAR) {
+    return false;
+  }
+  strcpy(szJournalFile, szBookFile);
+  lpExt = strrchr(szJournalFile, '.');
+  if (lpExt == NULL || strchr(lpExt, '/') != NULL || strchr(lpExt, '\\') != NULL) {
+    lpExt = szJournalFile + strlen(szJournalFile);
+  }
+  strcpy(lpExt, ".JNL");
+  return true;
+}
+
+void MakeBookJournal(BookJournalStruct &bj, const PositionStruct &pos, int mv, int nDelta) {
+  ZobristStruct zobrMirror;
+  pos.MirrorZobrist(zobrMirror);
+  if (BOOK_KEY(zobrMirror.dwLock1, zobrMirror.dwLock0) < BOOK_KEY(pos)) {
+    bj.dwLock1 = zobrMirror.dwLock1;
+    bj.dwLock0 = zobrMirror.dwLock0;
+    bj.wmv = MOVE_MIRROR(mv);
+  } else {
+    bj.dwLock1 = pos.zobr.dwLock1;
+    bj.dwLock0 = pos.zobr.dwLock0;
+    bj.wmv = mv;
+  }
+  bj.nDelta = nDelta;
+}
+
+// ѧϰ¼ֻ׷ӣддͬʱֿڱʹ
+bool AppendBookJournal(const char *szBookFile, const BookJournalStruct *lpbjs, int nLen) {
+  char szJournalFile[PATH_MAX_CHAR];
+  FILE *fp;
+  bool bSuccess;
+  if (!GetJournalFile(szJournalFile, szBookFile)) {
+    return false;
+  }
+  fp = fopen(szJournalFile, "ab");
+  if (fp == NULL) {
+    return false;
+  }
+  bSuccess = (fwrite(lpbjs, sizeof(BookJournalStruct), nLen, fp) == (size_t) nLen);
+  return fclose(fp) == 0 && bSuccess;
+}
+
+// ѧϰ¼Zobristŷ򣬲ϲͬŷ
+void LoadBookJournal(BookTableStruct &bt, const char *szJournalFile) {
+  BookJournalStruct bj;
+  FILE *fp;
+  int i, nLen;
+
+  if (bt.lpbrsJournal != NULL) {
+    delete[] bt.lpbrsJournal;
+    bt.lpbrsJournal = NULL;
+  }
+  bt.nJournalLen = 0;
+  // ȡļĴС޸ʱ䣬ڼ׷ӵļ¼´μʱ
+  if (!GetFileStamp(szJournalFile, bt.llJournalSize, bt.llJournalTime)) {
+    bt.llJournalSize = bt.llJournalTime = -1;
+  }
+  fp = fopen(szJournalFile, "rb");
+  if (fp == NULL) {
+    return;
+  }
+  fseek(fp, 0, SEEK_END);
+  nLen = (int) (ftell(fp) / sizeof(BookJournalStruct));
+  fseek(fp, 0, SEEK_SET);
+  if (nLen > 0) {
+    bt.lpbrsJournal = new BookRecordStruct[nLen];
+    for (i = 0; i < nLen; i ++) {
+      if (fread(&bj, sizeof(BookJournalStruct), 1, fp) != 1) {
         break;
       }
+      bt.lpbrsJournal[i].dwLock1 = bj.dwLock1;
+      bt.lpbrsJournal[i].dwLock0 = bj.dwLock0;
+      bt.lpbrsJournal[i].mv = bj.wmv;
+      bt.lpbrsJournal[i].vl = bj.nDelta;
     }
-    if (nLow <= nHigh) {
-      break;
+    nLen = i;
+    qsort(bt.lpbrsJournal, nLen, sizeof(BookRecordStruct), CompareRecordPtr);
+    for (i = 0; i < nLen; i ++) {
+      if (bt.nJournalLen > 0 && CompareRecord(bt.lpbrsJournal[bt.nJournalLen - 1], bt.lpbrsJournal[i]) == 0) {
+        bt.lpbrsJournal[bt.nJournalLen - 1].vl += bt.lpbrsJournal[i].vl;
+      } else {
+        bt.lpbrsJournal[bt.nJournalLen] = bt.lpbrsJournal[i];
+        bt.nJournalLen ++;
+      }
     }
-    // ԭ;һ
-    posScan.Mirror();
   }
+  fclose(fp);
+}
 
-  // 3. 棬򷵻ؿţ
-  if (nScan == 2) {
-    BookFile.Close();
+bool LoadBook(BookTableStruct &bt, const char *szBookFile, bool bJournal) {
+  char szJournalFile[PATH_MAX_CHAR];
+  const BookHeaderStruct *lpbh;
+  int64_t llSize;
+  int i;
+  DelBook(bt);
+  if (strlen(szBookFile) + 5 > PATH_MAX_CHAR) {
+    return false;
+  }
+  if (szBookFile != bt.szBookFile) {
+    strcpy(bt.szBookFile, szBookFile);
+  }
+  bt.lpMapped = MapFile(szBookFile, bt.nSize);
+  if (bt.lpMapped == NULL) {
+    return false;
+  }
+  if (!GetFileStamp(szBookFile, llSize, bt.llBookTime)) {
+    bt.llBookTime = -1;
+  }
+  bt.lpbrsJournal = NULL;
+  bt.nJournalLen = 0;
+  lpbh = (const BookHeaderStruct *) bt.lpMapped;
+  if (bt.nSize >= sizeof(BookHeaderStruct) && memcmp(lpbh->szMagic, cszBookMagic, 8) == 0) {
+    // ڶ濪ֿ⣬ļͷ׵Zobrist
+    if (lpbh->dwZobristKey != PreGen.zobrPlayer.dwKey || lpbh->dwZobristLock0 != PreGen.zobrPlayer.dwLock0 ||
+        lpbh->dwZobristLock1 != PreGen.zobrPlayer.dwLock1 || lpbh->qwIndexOffset > bt.nSize ||
+        lpbh->qwIndexOffset % 8 != 0 || lpbh->qwIndexOffset < sizeof(BookHeaderStruct) ||
+        bt.nSize - lpbh->qwIndexOffset != (uint64_t) lpbh->dwBlocks * sizeof(BookIndexStruct)) {
+      DelBook(bt);
+      return false;
+    }
+    bt.lpbh = lpbh;
+    bt.lpbis = (const BookIndexStruct *) ((const uint8_t *) bt.lpMapped + lpbh->qwIndexOffset);
+    bt.nLen = (int) lpbh->dwBlocks;
+    // ÿ鶼ļͷϡ֮
+    for (i = 0; i < bt.nLen; i ++) {
+      if (bt.lpbis[i].qwOffset < sizeof(BookHeaderStruct) || bt.lpbis[i].qwOffset >= lpbh->qwIndexOffset) {
+        DelBook(bt);
+        return false;
+      }
+    }
+    bt.nIndex[0] = 0;
+    for (i = 1; i < BOOK_INDEX_LEN; i ++) {
+      bt.nIndex[i] = BookUpperBound(bt.lpbis, bt.nIndex[i - 1], bt.nLen, BOOK_KEY(((uint32_t) i << BOOK_INDEX_SHIFT) - 1, 0xffffffff));
+    }
+  } else {
+    // һ濪ֿ⣬ÿֻһ֮ңֻҳ
+    bt.lpbks = (BookStruct *) bt.lpMapped;
+    bt.nLen = (int) (bt.nSize / sizeof(BookStruct));
+    bt.nIndex[0] = 0;
+    for (i = 1; i < BOOK_INDEX_LEN; i ++) {
+      bt.nIndex[i] = BookLowerBound(bt.lpbks, bt.nIndex[i - 1], bt.nLen, (uint32_t) i << BOOK_INDEX_SHIFT);
+    }
+  }
+  bt.nIndex[BOOK_INDEX_LEN] = bt.nLen;
+  if (bJournal && GetJournalFile(szJournalFile, szBookFile)) {
+    LoadBookJournal(bt, szJournalFile);
+  } else {
+    bt.llJournalSize = bt.llJournalTime = -1;
+  }
+  return true;
+}
+
+void DelBook(BookTableStruct &bt) {
+  if (bt.lpMapped != NULL) {
+    UnmapFile(bt.lpMapped, bt.nSize);
+    if (bt.lpbrsJournal != NULL) {
+      delete[] bt.lpbrsJournal;
+    }
+  }
+  bt.lpMapped = NULL;
+  bt.lpbks = NULL;
+  bt.lpbh = NULL;
+  bt.lpbis = NULL;
+  bt.nLen = 0;
+  bt.lpbrsJournal = NULL;
+  bt.nJournalLen = 0;
+}
+
+// ŷֵ
+static void SortBookMoves(BookStruct *lpbks, int nMoves) {
+  int i, j;
+  for (i = 0; i < nMoves - 1; i ++) {
+    for (j = nMoves - 1; j > i; j --) {
+      if (lpbks[j - 1].wvl < lpbks[j].wvl) {
+        SWAP(lpbks[j - 1], lpbks[j]);
+      }
+    }
+  }
+}
+
+// ӵڶ濪ֿŷ
+static int GetBookMoves2(const PositionStruct &pos, const BookTableStruct &bt, BookStruct *lpbks) {
+  ZobristStruct zobrMirror;
+  BitReaderStruct BitReader;
+  BookStruct bks[MAX_GEN_MOVES];
+  const uint8_t *lpucBlock;
+  uint64_t qwKey, qwScan;
+  bool bMirror;
+  int nBlock, nPositions, nShift, nCode, nMoves, nLen, mv;
+  int i, j;
+
+  // 1. ԭ;Уֻֿ¼ZobristСһ("MAKEBOOK.CPP")
+  pos.MirrorZobrist(zobrMirror);
+  qwKey = BOOK_KEY(zobrMirror.dwLock1, zobrMirror.dwLock0);
+  bMirror = qwKey < BOOK_KEY(pos);
+  if (!bMirror) {
+    qwKey = BOOK_KEY(pos);
+  }
+
+  // 2. ȷΧòҷڵĿ飻
+  i = (int) (qwKey >> (32 + BOOK_INDEX_SHIFT));
+  nBlock = BookUpperBound(bt.lpbis, bt.nIndex[i], bt.nIndex[i + 1], qwKey) - 1;
+  if (nBlock < 0) {
+    return 0;
+  }
+
+  // 3. ڿν룬ֱҵ߳棻
+  lpucBlock = (const uint8_t *) bt.lpMapped + bt.lpbis[nBlock].qwOffset;
+  nPositions = lpucBlock[0];
+  nShift = lpucBlock[1];
+  BitReader.lpuc = lpucBlock + 2;
+  BitReader.lpucEnd = (const uint8_t *) bt.lpbis;
+  BitReader.qwBits = 0;
+  qwScan = BOOK_KEY(bt.lpbis[nBlock]);
+  nLen = 0;
+  for (i = 0; i < nPositions; i ++) {
+    if (i > 0) {
+      qwScan += BitReader.GetRice(nShift) + 1;
+    }
+    nLen = (int) BitReader.GetGamma();
+    if (qwScan >= qwKey || nLen == 0 || nLen > MAX_GEN_MOVES) {
+      break;
+    }
+    for (j = 0; j < nLen; j ++) {
+      if (j == 0) {
+        BitReader.GetBits(BOOK_CODE_BITS);
+      } else {
+        BitReader.GetGamma();
+      }
+      BitReader.GetGamma();
+    }
+  }
+  if (i == nPositions || qwScan != qwKey || nLen == 0 || nLen > MAX_GEN_MOVES) {
     return 0;
   }
-  __ASSERT_BOUND(0, nPtr, BookFile.nLen - 1);
 
-  // 4. ҵ棬ǰҵһŷ
-  for (nPtr --; nPtr >= 0; nPtr --) {
-    BookFile.Read(bk, nPtr);
-    if (BOOK_POS_CMP(bk, posScan) < 0) {
+  // 4. þÿŷŷʹ˳͵һ濪ֿһ£
+  nCode = 0;
+  for (j = 0; j < nLen; j ++) {
+    nCode = (j == 0 ? (int) BitReader.GetBits(BOOK_CODE_BITS) : nCode + (int) BitReader.GetGamma());
+    bks[j].wmv = (nCode < 8100 ? BOOK_CODE_MOVE(nCode) : 0);
+    bks[j].wvl = (uint16_t) (BitReader.GetGamma() - 1);
+  }
+  for (i = 1; i < nLen; i ++) {
+    for (j = i; j > 0 && bks[j - 1].wmv > bks[j].wmv; j --) {
+      SWAP(bks[j - 1], bks[j]);
+    }
+  }
+  nMoves = 0;
+  for (j = 0; j < nLen; j ++) {
+    // ҵǾ棬ŷ
+    mv = (bMirror ? MOVE_MIRROR(bks[j].wmv) : bks[j].wmv);
+    if (bks[j].wmv != 0 && pos.LegalMove(mv)) {
+      lpbks[nMoves].nPtr = -1;
+      lpbks[nMoves].wmv = mv;
+      lpbks[nMoves].wvl = bks[j].wvl;
+      nMoves ++;
+    }
+  }
+  SortBookMoves(lpbks, nMoves);
+  return nMoves;
+}
+
+// ӵһ濪ֿŷ
+static int GetBookMoves1(const PositionStruct &pos, const BookTableStruct &bt, BookStruct *lpbks) {
+  ZobristStruct zobrMirror;
+  const BookStruct *lpbk;
+  uint32_t dwLock;
+  int nScan, nPtr, nHigh, nMoves, mv;
+  // ӿֿỵ̂¼裺
+
+  // 1. ȷΧòҷĵһŷԭ;һˣ
+  pos.MirrorZobrist(zobrMirror);
+  dwLock = nPtr = nHigh = 0;
+  for (nScan = 0; nScan < 2; nScan ++) {
+    dwLock = (nScan == 0 ? pos.zobr.dwLock1 : zobrMirror.dwLock1);
+    nHigh = bt.nIndex[(dwLock >> BOOK_INDEX_SHIFT) + 1];
+    nPtr = BookLowerBound(bt.lpbks, bt.nIndex[dwLock >> BOOK_INDEX_SHIFT], nHigh, dwLock);
+    if (nPtr < nHigh && bt.lpbks[nPtr].dwZobristLock == dwLock) {
       break;
     }
   }
 
-  // 5. ζڸþÿŷ
+  // 2. 棬򷵻ؿţ
+  if (nScan == 2) {
+    return 0;
+  }
+  __ASSERT_BOUND(0, nPtr, bt.nLen - 1);
+
+  // 3. ζڸþÿŷ
   nMoves = 0;
-  for (nPtr ++; nPtr < BookFile.nLen; nPtr ++) {
-    BookFile.Read(bk, nPtr);
-    if (BOOK_POS_CMP(bk, posScan) > 0) {
+  for (; nPtr < nHigh; nPtr ++) {
+    lpbk = bt.lpbks + nPtr;
+    if (lpbk->dwZobristLock != dwLock) {
       break;
     }
-    if (posScan.LegalMove(bk.wmv)) {
-      // ǵڶģŷ
+    // ǵڶģŷ
+    mv = (nScan == 0 ? lpbk->wmv : MOVE_MIRROR(lpbk->wmv));
+    if (pos.LegalMove(mv)) {
       lpbks[nMoves].nPtr = nPtr;
-      lpbks[nMoves].wmv = (nScan == 0 ? bk.wmv : MOVE_MIRROR(bk.wmv));
-      lpbks[nMoves].wvl = bk.wvl;
+      lpbks[nMoves].wmv = mv;
+      lpbks[nMoves].wvl = lpbk->wvl;
       nMoves ++;
       if (nMoves == MAX_GEN_MOVES) {
         break;
       }
     }
   }
-  BookFile.Close();
 
-  // 6. ŷֵ
-  for (i = 0; i < nMoves - 1; i ++) {
-    for (j = nMoves - 1; j > i; j --) {
-      if (lpbks[j - 1].wvl < lpbks[j].wvl) {
-        SWAP(lpbks[j - 1], lpbks[j]);
+  // 4. ŷֵ
+  SortBookMoves(lpbks, nMoves);
+  return nMoves;
+}
+
+// ѧϰ¼ӵҵŷϣȨؼŷȥ
+static int ApplyJournal(const PositionStruct &pos, const BookTableStruct &bt, BookStruct *lpbks, int nMoves) {
+  ZobristStruct zobrMirror;
+  BookRecordStruct brKey;
+  bool bMirror;
+  int i, nLow, nHigh, nPtr, mv, vl;
+
+  // 1. ҵĵһ¼
+  pos.MirrorZobrist(zobrMirror);
+  bMirror = BOOK_KEY(zobrMirror.dwLock1, zobrMirror.dwLock0) < BOOK_KEY(pos);
+  brKey.dwLock1 = (bMirror ? zobrMirror.dwLock1 : pos.zobr.dwLock1);
+  brKey.dwLock0 = (bMirror ? zobrMirror.dwLock0 : pos.zobr.dwLock0);
+  brKey.mv = 0;
+  nLow = 0;
+  nHigh = bt.nJournalLen;
+  while (nLow < nHigh) {
+    nPtr = (nLow + nHigh) / 2;
+    if (CompareRecord(bt.lpbrsJournal[nPtr], brKey) < 0) {
+      nLow = nPtr + 1;
+    } else {
+      nHigh = nPtr;
+    }
+  }
+
+  // 2. εӸþÿ¼
+  for (nPtr = nLow; nPtr < bt.nJournalLen; nPtr ++) {
+    if (bt.lpbrsJournal[nPtr].dwLock1 != brKey.dwLock1 || bt.lpbrsJournal[nPtr].dwLock0 != brKey.dwLock0) {
+      break;
+    }
+    mv = (bMirror ? MOVE_MIRROR(bt.lpbrsJournal[nPtr].mv) : bt.lpbrsJournal[nPtr].mv);
+    for (i = 0; i < nMoves; i ++) {
+      if (lpbks[i].wmv == mv) {
+        vl = lpbks[i].wvl + bt.lpbrsJournal[nPtr].vl;
+        lpbks[i].wvl = MIN(MAX(vl, 0), 65535);
       }
     }
   }
+  if (nPtr == nLow) {
+    return nMoves;
+  }
+
+  // 3. ȥȨΪŷ
+  nPtr = 0;
+  for (i = 0; i < nMoves; i ++) {
+    if (lpbks[i].wvl > 0) {
+      lpbks[nPtr] = lpbks[i];
+      nPtr ++;
+    }
+  }
+  SortBookMoves(lpbks, nPtr);
+  return nPtr;
+}
+
+int GetBookMoves(const PositionStruct &pos, const BookTableStruct &bt, BookStruct *lpbks) {
+  int nMoves;
+  if (bt.lpMapped == NULL) {
+    return 0;
+  }
+  nMoves = (bt.lpbh == NULL ? GetBookMoves1(pos, bt, lpbks) : GetBookMoves2(pos, bt, lpbks));
+  if (nMoves > 0 && bt.nJournalLen > 0) {
+    nMoves = ApplyJournal(pos, bt, lpbks, nMoves);
+  }
+  return nMoves;
+}
+
+int ReadBookBlock(const BookTableStruct &bt, int nBlock, BookRecordStruct *lpbrs) {
+  BitReaderStruct BitReader;
+  const uint8_t *lpucBlock;
+  uint64_t qwScan;
+  int nPositions, nShift, nCode, nLen, nRecords, mv;
+  int i, j, k, n;
+
+  lpucBlock = (const uint8_t *) bt.lpMapped + bt.lpbis[nBlock].qwOffset;
+  nPositions = lpucBlock[0];
+  nShift = lpucBlock[1];
+  BitReader.lpuc = lpucBlock + 2;
+  BitReader.lpucEnd = (const uint8_t *) bt.lpbis;
+  BitReader.qwBits = 0;
+  qwScan = BOOK_KEY(bt.lpbis[nBlock]);
+  nRecords = 0;
+  for (i = 0; i < nPositions; i ++) {
+    if (i > 0) {
+      qwScan += BitReader.GetRice(nShift) + 1;
+    }
+    nLen = (int) BitReader.GetGamma();
+    if (nLen == 0 || nLen > MAX_GEN_MOVES) {
+      break;
+    }
+    nCode = 0;
+    k = nRecords;
+    for (j = 0; j < nLen; j ++) {
+      nCode = (j == 0 ? (int) BitReader.GetBits(BOOK_CODE_BITS) : nCode + (int) BitReader.GetGamma());
+      mv = (nCode < 8100 ? BOOK_CODE_MOVE(nCode) : 0);
+      lpbrs[nRecords].dwLock1 = (uint32_t) (qwScan >> 32);
+      lpbrs[nRecords].dwLock0 = (uint32_t) qwScan;
+      lpbrs[nRecords].mv = mv;
+      lpbrs[nRecords].vl = (int) BitReader.GetGamma() - 1;
+      nRecords += (mv == 0 ? 0 : 1);
+    }
+    for (j = k + 1; j < nRecords; j ++) {
+      for (n = j; n > k && lpbrs[n - 1].mv > lpbrs[n].mv; n --) {
+        SWAP(lpbrs[n - 1], lpbrs[n]);
+      }
+    }
+  }
+  return nRecords;
+}
+
+bool LoadBooks(BookListStruct &bl, const char *szBookFiles) {
+  char szBookFile[PATH_MAX_CHAR], szEntry[PATH_MAX_CHAR];
+  const char *lpEntry;
+  char *lpFactor;
+  int nLen, nFactor;
+
+  DelBooks(bl);
+  bl.bCombine = false;
+  lpEntry = szBookFiles;
+  while (*lpEntry != '\0' && bl.nBooks < MAX_BOOK_FILES) {
+    // 1. ȡһļȥβĿո
+    while (*lpEntry == ' ') {
+      lpEntry ++;
+    }
+    nLen = (int) strcspn(lpEntry, ";");
+    strncpy(szEntry, lpEntry, MIN(nLen, PATH_MAX_CHAR - 1));
+    szEntry[MIN(nLen, PATH_MAX_CHAR - 1)] = '\0';
+    lpEntry += (lpEntry[nLen] == ';' ? nLen + 1 : nLen);
+    nLen = (int) strlen(szEntry);
+    while (nLen > 0 && szEntry[nLen - 1] == ' ') {
+      nLen --;
+      szEntry[nLen] = '\0';
+    }
+    // 2. ļ"*"ϵ
+    nFactor = 1;
+    lpFactor = strrchr(szEntry, '*');
+    if (lpFactor != NULL && lpFactor[1] != '\0' && strspn(lpFactor + 1, "0123456789") == strlen(lpFactor + 1)) {
+      nFactor = MIN(atoi(lpFactor + 1), MAX_BOOK_FACTOR);
+      bl.bCombine = true;
+      *lpFactor = '\0';
+    }
+    if (szEntry[0] == '\0') {
+      continue;
+    }
+    // 3. ӳ俪ֿ⣬򲻿Ŀֿ
+    LocatePath(szBookFile, szEntry);
+    bl.Books[bl.nBooks].lpMapped = NULL;
+    if (LoadBook(bl.Books[bl.nBooks], szBookFile)) {
+      bl.nFactors[bl.nBooks] = nFactor;
+      bl.nBooks ++;
+    }
+  }
+  return bl.nBooks > 0;
+}
+
+void DelBooks(BookListStruct &bl) {
+  int i;
+  for (i = 0; i < bl.nBooks; i ++) {
+    DelBook(bl.Books[i]);
+  }
+  bl.nBooks = 0;
+}
+
+void RefreshBooks(BookListStruct &bl) {
+  char szJournalFile[PATH_MAX_CHAR];
+  int64_t llSize, llTime;
+  int i;
+  for (i = 0; i < bl.nBooks; i ++) {
+    // 1. ֿļдʱӳ俪ֿ⣬ͬʱѧϰ¼
+    if (bl.Books[i].lpMapped == NULL || !GetFileStamp(bl.Books[i].szBookFile, llSize, llTime) ||
+        (size_t) llSize != bl.Books[i].nSize || llTime != bl.Books[i].llBookTime) {
+      LoadBook(bl.Books[i], bl.Books[i].szBookFile);
+      continue;
+    }
+    // 2. ѧϰ¼ļб仯ʱֻ¶ѧϰ¼
+    if (!GetJournalFile(szJournalFile, bl.Books[i].szBookFile)) {
+      continue;
+    }
+    if (!GetFileStamp(szJournalFile, llSize, llTime)) {
+      llSize = llTime = -1;
+    }
+    if (llSize != bl.Books[i].llJournalSize || llTime != bl.Books[i].llJournalTime) {
+      LoadBookJournal(bl.Books[i], szJournalFile);
+    }
+  }
+}
+
+int GetBookMoves(const PositionStruct &pos, const BookListStruct &bl, BookStruct *lpbks) {
+  BookStruct bks[MAX_GEN_MOVES];
+  int vls[MAX_GEN_MOVES];
+  int i, j, k, nMoves, nLen;
+
+  // 1. ϲʱصһҵŷĿֿŷ
+  if (!bl.bCombine) {
+    for (i = 0; i < bl.nBooks; i ++) {
+      nMoves = GetBookMoves(pos, bl.Books[i], lpbks);
+      if (nMoves > 0) {
+        return nMoves;
+      }
+    }
+    return 0;
+  }
+
+  // 2. ϲʱͬŷȨسϵӣ
+  nMoves = 0;
+  for (i = 0; i < bl.nBooks; i ++) {
+    if (bl.nFactors[i] == 0) {
+      continue;
+    }
+    nLen = GetBookMoves(pos, bl.Books[i], bks);
+    for (j = 0; j < nLen; j ++) {
+      for (k = 0; k < nMoves; k ++) {
+        if (lpbks[k].wmv == bks[j].wmv) {
+          break;
+        }
+      }
+      if (k == nMoves) {
+        if (nMoves == MAX_GEN_MOVES) {
+          continue;
+        }
+        lpbks[k].nPtr = -1;
+        lpbks[k].wmv = bks[j].wmv;
+        vls[k] = 0;
+        nMoves ++;
+      }
+      vls[k] += bks[j].wvl * bl.nFactors[i];
+    }
+  }
+
+  // 3. ȥȨΪŷȨ
+  nLen = 0;
+  for (k = 0; k < nMoves; k ++) {
+    if (vls[k] > 0) {
+      lpbks[nLen] = lpbks[k];
+      lpbks[nLen].wvl = MIN(vls[k], 65535);
+      nLen ++;
+    }
+  }
+  SortBookMoves(lpbks, nLen);
+  return nLen;
+}
+
+// ֿ༭ѷصȨдؿֿ⣬Բܵѧϰ¼ϲѧϰ¼ʱظ
+int GetBookMoves(const PositionStruct &pos, const char *szBookFile, BookStruct *lpbks) {
+  BookTableStruct bt;
+  int nMoves;
+  bt.lpMapped = NULL;
+  LoadBook(bt, szBookFile, false);
+  nMoves = GetBookMoves(pos, bt, lpbks);
+  DelBook(bt);
   return nMoves;
 }
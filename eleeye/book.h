@@ -66,7 +66,143 @@ struct BookFileStruct {
   }
 };
 
-// ȡֿŷ
+/* ڶ濪ֿ(ļͷ"EEBOOK02")64λZobrist("dwLock1"ڸλ"dwLock0"ڵλ)ȷ棬Ǿȷġ
+ * 水Zobristÿ"BOOK_BLOCK_LEN"һ飬ڰλѹ
+ * (1) ׾Zobrist¼ϡ¼ǰһĲֵ(Rice룬¼ڿ)
+ * (2) ÿ¼ŷ(Gamma)ŷյ08099һ13λ¼¼ֵ(Gamma)
+ * (3) ÿŷȨؼ1Gamma¼
+ * ڶ濪ֻֿģ"BookWriterStruct"һдɣĴ"MAKEBOOK.CPP"һ£ֻ¼ZobristСһ
+ */
+const int BOOK_BLOCK_LEN = 64;
+
+struct BookHeaderStruct {
+  char szMagic[8];                                        // "EEBOOK02"
+  uint32_t dwZobristKey, dwZobristLock0, dwZobristLock1;  // ӷZobristֵжļǷͬZobrist
+  uint32_t dwBlocks, dwPositions, dwRecords;              // ŷ
+  uint64_t qwIndexOffset;                                 // ϡļеλ
+}; // bh
+
+struct BookIndexStruct {
+  uint32_t dwLock1, dwLock0;                              // ׾Zobrist
+  uint64_t qwOffset;                                      // ļеλ
+}; // bi
+
+// ѵڶ濪ֿĸдļ밴Zobrist("dwLock1")ŷ˳"Add()"ͬһظŷϲȨ
+struct BookWriterStruct {
+  FILE *fp;
+  char szFileName[1024], szTempFile[1024];              // ֿļʱļ
+  uint32_t dwLock1, dwLock0;                              // ǰZobrist
+  int nMoves, nPositions;                                 // ǰŷ͵ǰľ
+  BookHeaderStruct bh;
+  BookIndexStruct *lpbis;                                 // ϡ
+  int nIndexMax;
+  uint64_t *lpqwKeys;                                     // ǰÿZobrist
+  int *lpnMoves;                                          // ǰÿŷ
+  uint16_t *lpwCodes, *lpwvls;                            // ǰÿŷıȨ
+  int nCodes;
+  uint8_t *lpucBlock;                                     // ѹĿ
+  bool bError;
+
+  bool Open(const char *szBookFile);
+  void Add(uint32_t dwZobristLock1, uint32_t dwZobristLock0, int mv, int vl);
+  bool Close(void);                                       // дʱļɹŸƻʹõĿֿ
+  void EndPosition(void);                                 // ֻڲ
+  void FlushBlock(void);
+};
+
+/* ֿѧϰ¼Ծֽģȳ׷ӵֿԱߵļ¼ļ(չĳ".JNL")
+ * ֿⱾøдӳ俪ֿʱ¼ʱȨصӵֿеŷϣ
+ * Ժ"FOLDBOOK"Ѽ¼ϲֿŷļ¼Ϳֿһ£ԭ;ֻ¼ZobristСһ
+ */
+struct BookJournalStruct {
+  uint32_t dwLock1, dwLock0;                              // Zobrist
+  uint16_t wmv;                                           // ŷ
+  int16_t nDelta;                                         // Ȩص
+}; // bj
+
+// Zobristŷ¼ڴеѧϰ¼͵ڶ濪ֿĽ
+struct BookRecordStruct {
+  uint32_t dwLock1, dwLock0;
+  int mv, vl;
+}; // br
+
+const int BOOK_BLOCK_RECORDS = BOOK_BLOCK_LEN * MAX_GEN_MOVES; // һŷ
+
+const int BOOK_INDEX_BITS = 12;                          // ֿZobristĸ12λ
+const int BOOK_INDEX_SHIFT = 32 - BOOK_INDEX_BITS;
+const int BOOK_INDEX_LEN = 1 << BOOK_INDEX_BITS;
+
+/* ӳ䵽ڴĿֿ⣬ֻÿֿļʱһΣԺÿβҶҪļ
+ * ֿⰴZobrist"nIndex[i]"ǵһZobristĸλС"i"ļ¼(ڶ濪ֿǿ)
+ * һֻҪ"nIndex[i]""nIndex[i + 1]"֮ңֻͨһҳ档
+ */
+struct BookTableStruct {
+  void *lpMapped;                    // ӳ䵽ڴĿֿļNULLʾûпֿ
+  size_t nSize;                      // ӳֽ
+  BookStruct *lpbks;                 // һ濪ֿļ¼ڶ濪ֿΪNULL
+  const BookHeaderStruct *lpbh;      // ڶ濪ֿļͷһ濪ֿΪNULL
+  const BookIndexStruct *lpbis;      // ڶ濪ֿϡ
+  int nLen;                          // ¼(ڶ濪ֿǿ)
+  int nIndex[BOOK_INDEX_LEN + 1];    // һ
+  BookRecordStruct *lpbrsJournal;    // ѧϰ¼(ZobristŷͬŷѺϲ)
+  int nJournalLen;
+  char szBookFile[1024];             // ֿļ
+  int64_t llBookTime;                // ӳʱֿļ޸ʱ
+  int64_t llJournalSize, llJournalTime; // ʱѧϰ¼ļĴС޸ʱ䣬ûм¼ļʱΪ-1
+}; // bt
+
+/* ֿ⣬"bookfiles"ѡ÷ֺŷָ"REPERTOIRE.DAT;BOOK.DAT"ÿֿⶼӳ䵽ڴ棬˳ң
+ * (1) ûָϵʱһҵŷĿֿ˵㣬ֹСֿԸͳƵõĴ󿪾ֿ⣻
+ * (2) ļ"*"ָϵʱ("REPERTOIRE.DAT*8;BOOK.DAT")пֿŷϲһ
+ *     ȨسϵӣûָϵĿֿϵΪ1ϵΪ0Ŀֿⲻá
+ */
+const int MAX_BOOK_FILES = 8;
+const int MAX_BOOK_FACTOR = 1024;
+
+struct BookListStruct {
+  int nBooks;                                // ɹӳĿֿ
+  bool bCombine;                             // Ƿϲпֿŷ
+  int nFactors[MAX_BOOK_FILES];              // ϲʱÿֿϵ
+  BookTableStruct Books[MAX_BOOK_FILES];
+}; // bl
+
+// ӳ俪ֿļ(ְ汾)ͬʱѧϰ¼("bJournal"Ϊ"false"ʱ)ļ򲻿ʽʱ"false"ʱֿΪ
+bool LoadBook(BookTableStruct &bt, const char *szBookFile, bool bJournal = true);
+
+// ͷſֿ
+void DelBook(BookTableStruct &bt);
+
+// ȡֿŷڶ濪ֿⷵص"nPtr"-1
+int GetBookMoves(const PositionStruct &pos, const BookTableStruct &bt, BookStruct *lpbks);
+
+// ӳֺŷָĶֿļ(·ӳĿ¼)һֿӳɹͷ"true"
+bool LoadBooks(BookListStruct &bl, const char *szBookFiles);
+
+// ͷпֿ
+void DelBooks(BookListStruct &bl);
+
+// ÿֿʼʱãֻѧϰ¼ļб仯ʱ¶ѧϰ¼ֿļд(ϲѧϰ¼)ʱӳ
+void RefreshBooks(BookListStruct &bl);
+
+// Ӷֿлȡŷϲʱص"nPtr"-1
+int GetBookMoves(const PositionStruct &pos, const BookListStruct &bl, BookStruct *lpbks);
+
+// ڶ濪ֿһ飬ŷŷZobristŷ(ֿάʹ)
+int ReadBookBlock(const BookTableStruct &bt, int nBlock, BookRecordStruct *lpbrs);
+
+// ֿӦѧϰ¼ļ("szJournalFile"ĳ"PATH_MAX_CHAR")ļ̫ʱ"false"
+bool GetJournalFile(char *szJournalFile, const char *szBookFile);
+
+// һѧϰ¼"mv"Ǿ"pos"еŷ
+void MakeBookJournal(BookJournalStruct &bj, const PositionStruct &pos, int mv, int nDelta);
+
+// ѧϰ¼(ֿѾӳ)ԭѧϰ¼滻ϲѧϰ¼ĳļ¼ļ
+void LoadBookJournal(BookTableStruct &bt, const char *szJournalFile);
+
+// ѧϰ¼׷ӵֿӦļ¼ļ
+bool AppendBookJournal(const char *szBookFile, const BookJournalStruct *lpbjs, int nLen);
+
+// ȡֿŷ(ʱ򿪿ֿļֿ༭ʹ)ؿֿⱾȨأѧϰ¼
 int GetBookMoves(const PositionStruct &pos, const char *szBookFile, BookStruct *lpbks);
 
 #endif
@@ -25,12 +25,11 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../base/parse.h"
 #include "ucci.h"
 #include "pregen.h"
+#include "preeval.h"
 #include "position.h"
 #include "hash.h"
 #include "search.h"
 
-const int INTERRUPT_COUNT = 4096; // ɽж
-
 inline void PrintLn(const char *sz) {
   printf("%s\n", sz);
   fflush(stdout);
@@ -38,27 +37,26 @@ inline void PrintLn(const char *sz) {
 
 int main(void) {
   int i;
+  int64_t llSize, llTime;
   bool bPonderTime;
+  char szHashFile[PATH_MAX_CHAR];
   UcciCommStruct UcciComm;
   PositionStruct posProbe;
+  static EngineStruct eng;
+  SearchStruct &Search = eng.Search;
 
   if (BootLine() != UCCI_COMM_UCCI) {
     return 0;
   }
-  LocatePath(Search.szBookFile, "BOOK.DAT");
+  szHashFile[0] = '\0';
   bPonderTime = false;
   PreGenInit();
-  NewHash(24); // 24=16MB, 25=32MB, 26=64MB, ...
-  Search.pos.FromFen(cszStartFen);
-  Search.pos.nDistance = 0;
-  Search.pos.PreEvaluate();
-  Search.nBanMoves = 0;
-  Search.bQuit = Search.bBatch = Search.bDebug = false;
-  Search.bUseHash = Search.bUseBook = Search.bNullMove = Search.bKnowledge = true;
-  Search.bIdle = false;
-  Search.nCountMask = INTERRUPT_COUNT - 1;
-  Search.nRandomMask = 0;
-  Search.rc4Random.InitRand();
+  PreEvalInit();
+  if (!NewEngine(eng, 24)) { // 24=16MB, 25=32MB, 26=64MB, ...
+    return 0;
+  }
+  LocatePath(Search.szBookFile, "BOOK.DAT");
+  LoadBooks(eng.Books, Search.szBookFile);
   PrintLn("id name ElephantEye");
   PrintLn("id version 3.31");
   PrintLn("id copyright 2004-2016 www.xqbase.com");
@@ -73,7 +71,11 @@ int main(void) {
   PrintLn("option usebook type check default true");
   printf("option bookfiles type string default %s\n", Search.szBookFile);
   fflush(stdout);
-  PrintLn("option hashsize type spin min 16 max 1024 default 16");
+  PrintLn("option hashsize type spin min 16 max 65536 default 16");
+  PrintLn("option hashfile type string default <empty>");
+  printf("option threads type spin min 1 max %d default 1\n", MAX_THREADS);
+  printf("option multipv type spin min 1 max %d default 1\n", MAX_MULTI_PV);
+  fflush(stdout);
   PrintLn("option idle type combo var none var small var medium var large default none");
   PrintLn("option pruning type combo var none var small var medium var large default large");
   PrintLn("option knowledge type combo var none var small var medium var large default large");
@@ -91,7 +93,7 @@ int main(void) {
       PrintLn("nobestmove");
       break;
     case UCCI_COMM_POSITION:
-      BuildPos(Search.pos, UcciComm);
+      BuildPos(eng, Search.pos, UcciComm);
       Search.pos.nDistance = 0;
       Search.pos.PreEvaluate();
       Search.nBanMoves = 0;
@@ -105,7 +107,7 @@ int main(void) {
     case UCCI_COMM_SETOPTION:
       switch (UcciComm.Option) {
       case UCCI_OPTION_PROMOTION:
-        PreEval.bPromotion = UcciComm.bCheck;
+        eng.PreEval.bPromotion = UcciComm.bCheck;
         break;
       case UCCI_OPTION_BATCH:
         Search.bBatch = UcciComm.bCheck;
@@ -123,20 +125,40 @@ int main(void) {
         Search.bUseBook = UcciComm.bCheck;
         break;
       case UCCI_OPTION_BOOKFILES:
-        if (AbsolutePath(UcciComm.szOption)) {
-          strcpy(Search.szBookFile, UcciComm.szOption);
-        } else {
-          LocatePath(Search.szBookFile, UcciComm.szOption);
-        }
+        strcpy(Search.szBookFile, UcciComm.szOption);
+        LoadBooks(eng.Books, Search.szBookFile);
         break;
       case UCCI_OPTION_HASHSIZE:
-        DelHash();
+        // µû䲻ʱʹԭû
         i = 19; // С10.5Mû
         while (UcciComm.nSpin > 0) {
           UcciComm.nSpin /= 2;
           i ++;
         }
-        NewHash(MAX(i, 24)); // СûΪ16M
+        NewHash(eng.Hash, MAX(i, 24)); // СûΪ16M
+        break;
+      case UCCI_OPTION_HASHFILE:
+        // ָûļļھӳ䵽û˳ʱٱ
+        if (StrEqv(UcciComm.szOption, "<empty>")) {
+          szHashFile[0] = '\0';
+        } else {
+          if (AbsolutePath(UcciComm.szOption)) {
+            strcpy(szHashFile, UcciComm.szOption);
+          } else {
+            LocatePath(szHashFile, UcciComm.szOption);
+          }
+          // ļģ˳ʱŻɣļȴӳ䲻(粻汾ûļ)Ҫʾ
+          if (!LoadHash(eng.Hash, szHashFile) && GetFileStamp(szHashFile, llSize, llTime)) {
+            printf("info string hashfile %s cannot be loaded and will be overwritten on quit\n", szHashFile);
+            fflush(stdout);
+          }
+        }
+        break;
+      case UCCI_OPTION_THREADS:
+        SetThreads(eng, UcciComm.nSpin);
+        break;
+      case UCCI_OPTION_MULTIPV:
+        Search.nMultiPv = UcciComm.nSpin;
         break;
       case UCCI_OPTION_IDLE:
         switch (UcciComm.Grade) {
@@ -190,6 +212,10 @@ int main(void) {
           break;
         }
         break;
+      case UCCI_OPTION_NEWGAME:
+        NewGame(eng);
+        RefreshBooks(eng.Books); // µѧϰ¼
+        break;
       default:
         break;
       }
@@ -200,13 +226,13 @@ int main(void) {
       switch (UcciComm.Go) {
       case UCCI_GO_DEPTH:
         Search.nGoMode = GO_MODE_INFINITY;
-        Search.nNodes = 0;
-        SearchMain(UcciComm.nDepth);
+        Search.llNodes = 0;
+        SearchMain(eng, UcciComm.nDepth);
         break;
       case UCCI_GO_NODES:
         Search.nGoMode = GO_MODE_NODES;
-        Search.nNodes = UcciComm.nNodes;
-        SearchMain(UCCI_MAX_DEPTH);
+        Search.llNodes = UcciComm.llNodes;
+        SearchMain(eng, UCCI_MAX_DEPTH);
         break;
       case UCCI_GO_TIME_MOVESTOGO:
       case UCCI_GO_TIME_INCREMENT:
@@ -224,18 +250,24 @@ int main(void) {
         // Ą̊́˼ʱԣôʵʱΪԭ1.25
         Search.nProperTimer += (bPonderTime ? Search.nProperTimer / 4 : 0);
         Search.nMaxTimer = MIN(Search.nMaxTimer, Search.nProperTimer * 10);
-        SearchMain(UCCI_MAX_DEPTH);
+        SearchMain(eng, UCCI_MAX_DEPTH);
         break;
       default:
         break;
       }
       break;
     case UCCI_COMM_PROBE:
-      BuildPos(posProbe, UcciComm);
+      BuildPos(eng, posProbe, UcciComm);
       if (!PopHash(posProbe)) {
-        PopLeaf(posProbe);
+        PopLeaf(eng, posProbe);
       }
       break;
+    case UCCI_COMM_PERFT:
+      PopPerft(Search.pos, UcciComm.nTestDepth, UcciComm.bDivide);
+      break;
+    case UCCI_COMM_BENCH:
+      PopBench(UcciComm.nTestDepth);
+      break;
     case UCCI_COMM_QUIT:
       Search.bQuit = true;
       break;
@@ -243,7 +275,10 @@ int main(void) {
       break;
     }
   }
-  DelHash();
+  if (szHashFile[0] != '\0') {
+    SaveHash(eng.Hash, szHashFile);
+  }
+  DelEngine(eng);
   PrintLn("bye");
   return 0;
 }
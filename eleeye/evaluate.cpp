@@ -104,11 +104,11 @@ int PositionStruct::AdvisorShape(void) const {
               lpsms = this->FileMaskPtr(x, y);
               if ((lpsms->wRookCap & WHITE_KING_BITFILE) != 0) {
                 // ͷڵв
-                vlWhitePenalty += PreEvalEx.vlHollowThreat[RANK_FLIP(y)];
+                vlWhitePenalty += lpPreEvalEx->vlHollowThreat[RANK_FLIP(y)];
               } else if ((lpsms->wSuperCap & WHITE_KING_BITFILE) != 0 &&
                   (this->ucpcSquares[0xb7] == 21 || this->ucpcSquares[0xb7] == 22)) {
                 // в
-                vlWhitePenalty += PreEvalEx.vlCentralThreat[RANK_FLIP(y)];
+                vlWhitePenalty += lpPreEvalEx->vlCentralThreat[RANK_FLIP(y)];
               }
             }
           }
@@ -124,7 +124,7 @@ int PositionStruct::AdvisorShape(void) const {
             if (x == FILE_CENTER) {
               if ((this->FileMaskPtr(x, y)->wSuperCap & WHITE_KING_BITFILE) != 0) {
                 // һڵв˧()űԷƵĻжⷣ
-                vlWhitePenalty += (PreEvalEx.vlCentralThreat[RANK_FLIP(y)] >> 2) +
+                vlWhitePenalty += (lpPreEvalEx->vlCentralThreat[RANK_FLIP(y)] >> 2) +
                     (this->Protected(1, nShape == SHAPE_LEFT ? 0xc8 : 0xc6) ? 20 : 0);
                 // ڵ߱˧()ķ֣
                 for (pcRook = SIDE_TAG(0) + ROOK_FROM; pcRook <= SIDE_TAG(0) + ROOK_TO; pcRook ++) {
@@ -143,7 +143,7 @@ int PositionStruct::AdvisorShape(void) const {
             } else if (y == RANK_BOTTOM) {
               if ((this->RankMaskPtr(x, y)->wRookCap & KING_BITRANK) != 0) {
                 // ڵв
-                vlWhitePenalty += PreEvalEx.vlWhiteBottomThreat[x];
+                vlWhitePenalty += lpPreEvalEx->vlWhiteBottomThreat[x];
               }
             }
           }
@@ -159,7 +159,7 @@ int PositionStruct::AdvisorShape(void) const {
   } else {
     if ((this->wBitPiece[1] & ROOK_BITPIECE) == ROOK_BITPIECE) {
       // ȱ(ʿ)˫з
-      vlWhitePenalty += PreEvalEx.vlWhiteAdvisorLeakage;
+      vlWhitePenalty += lpPreEvalEx->vlWhiteAdvisorLeakage;
     }
   }
   if ((this->wBitPiece[1] & ADVISOR_BITPIECE) == ADVISOR_BITPIECE) {
@@ -189,11 +189,11 @@ int PositionStruct::AdvisorShape(void) const {
               lpsms = this->FileMaskPtr(x, y);
               if ((lpsms->wRookCap & BLACK_KING_BITFILE) != 0) {
                 // ͷڵв
-                vlBlackPenalty += PreEvalEx.vlHollowThreat[y];
+                vlBlackPenalty += lpPreEvalEx->vlHollowThreat[y];
               } else if ((lpsms->wSuperCap & BLACK_KING_BITFILE) != 0 &&
                   (this->ucpcSquares[0x47] == 37 || this->ucpcSquares[0x47] == 38)) {
                 // в
-                vlBlackPenalty += PreEvalEx.vlCentralThreat[y];
+                vlBlackPenalty += lpPreEvalEx->vlCentralThreat[y];
               }
             }
           }
@@ -209,7 +209,7 @@ int PositionStruct::AdvisorShape(void) const {
             if (x == FILE_CENTER) {
               if ((this->FileMaskPtr(x, y)->wSuperCap & BLACK_KING_BITFILE) != 0) {
                 // һڵв˧()űԷƵĻжⷣ
-                vlBlackPenalty += (PreEvalEx.vlCentralThreat[y] >> 2) +
+                vlBlackPenalty += (lpPreEvalEx->vlCentralThreat[y] >> 2) +
                     (this->Protected(0, nShape == SHAPE_LEFT ? 0x38 : 0x36) ? 20 : 0);
                 // ڵ߱˧()ķ֣
                 for (pcRook = SIDE_TAG(1) + ROOK_FROM; pcRook <= SIDE_TAG(1) + ROOK_TO; pcRook ++) {
@@ -228,7 +228,7 @@ int PositionStruct::AdvisorShape(void) const {
             } else if (y == RANK_TOP) {
               if ((this->RankMaskPtr(x, y)->wRookCap & KING_BITRANK) != 0) {
                 // ڵв
-                vlBlackPenalty += PreEvalEx.vlBlackBottomThreat[x];
+                vlBlackPenalty += lpPreEvalEx->vlBlackBottomThreat[x];
               }
             }
           }
@@ -244,7 +244,7 @@ int PositionStruct::AdvisorShape(void) const {
   } else {
     if ((this->wBitPiece[0] & ROOK_BITPIECE) == ROOK_BITPIECE) {
       // ȱ(ʿ)˫з
-      vlBlackPenalty += PreEvalEx.vlBlackAdvisorLeakage;
+      vlBlackPenalty += lpPreEvalEx->vlBlackAdvisorLeakage;
     }
   }
   return SIDE_VALUE(this->sdPlayer, vlBlackPenalty - vlWhitePenalty);
@@ -480,7 +480,10 @@ int PositionStruct::StringHold(void) const {
 // ǵ֣Ե
 
 int PositionStruct::RookMobility(void) const {
-  int sd, i, sqSrc, nSideTag, x, y;
+  int sd, i, sqSrc, nSideTag;
+#ifndef BITBOARD
+  int x, y;
+#endif
   int vlRookMobility[2];
   for (sd = 0; sd < 2; sd ++) {
     vlRookMobility[sd] = 0;
@@ -489,10 +492,14 @@ int PositionStruct::RookMobility(void) const {
       sqSrc = this->ucsqPieces[nSideTag + i];
       if (sqSrc != 0) {
         __ASSERT_SQUARE(sqSrc);
+#ifdef BITBOARD
+        vlRookMobility[sd] += this->SlideNonCaps(sqSrc).PopCnt();
+#else
         x = FILE_X(sqSrc);
         y = RANK_Y(sqSrc);
-        vlRookMobility[sd] += PreEvalEx.cPopCnt16[this->RankMaskPtr(x, y)->wNonCap] +
-            PreEvalEx.cPopCnt16[this->FileMaskPtr(x, y)->wNonCap];
+        vlRookMobility[sd] += PreGen.cPopCnt16[this->RankMaskPtr(x, y)->wNonCap] +
+            PreGen.cPopCnt16[this->FileMaskPtr(x, y)->wNonCap];
+#endif
       }
     }
     __ASSERT(vlRookMobility[sd] <= 34);
@@ -570,43 +577,66 @@ int PositionStruct::KnightTrap(void) const {
 
 // ǵĲ֣ܵ谭
 
-// ۹
-int PositionStruct::Evaluate(int vlAlpha, int vlBeta) const {
-  int vl;
+/* ۹
+ *
+ * ۻ"ecs"¼˸þ͵һ("nLevel"²ı)ԼһΪֹķֵ
+ * иþʱֱӴӼ¼һȥԻ治ı۵Ľֻʡȥظļ㡣
+ */
+int PositionStruct::Evaluate(int vlAlpha, int vlBeta, EvalCacheStruct &ecs) const {
+  // ûиþ棬ʹͷʼ
+  if (ecs.dwLock0 != this->zobr.dwLock0 || ecs.dwLock1 != this->zobr.dwLock1) {
+    ecs.dwLock0 = this->zobr.dwLock0;
+    ecs.dwLock1 = this->zobr.dwLock1;
+    ecs.nLevel = 1;
+    ecs.vl = this->Material();
+  }
+
+  switch (ecs.nLevel) {
   // ͵ľۺ¼Σ
 
   // 1. ļ͵(͵)ֻƽ⣻
-  vl = this->Material();
-  if (vl + EVAL_MARGIN1 <= vlAlpha) {
-    return vl + EVAL_MARGIN1;
-  } else if (vl - EVAL_MARGIN1 >= vlBeta) {
-    return vl - EVAL_MARGIN1;
-  }
+  case 1:
+    if (ecs.vl + EVAL_MARGIN1 <= vlAlpha) {
+      return ecs.vl + EVAL_MARGIN1;
+    } else if (ecs.vl - EVAL_MARGIN1 >= vlBeta) {
+      return ecs.vl - EVAL_MARGIN1;
+    }
+    ecs.vl += this->AdvisorShape();
+    ecs.nLevel = 2;
+    // ɣû"break"ʾ"switch"һ"case"ִһ"case"ͬ
 
   // 2. ͵ۣͣ
-  vl += this->AdvisorShape();
-  if (vl + EVAL_MARGIN2 <= vlAlpha) {
-    return vl + EVAL_MARGIN2;
-  } else if (vl - EVAL_MARGIN2 >= vlBeta) {
-    return vl - EVAL_MARGIN2;
-  }
+  case 2:
+    if (ecs.vl + EVAL_MARGIN2 <= vlAlpha) {
+      return ecs.vl + EVAL_MARGIN2;
+    } else if (ecs.vl - EVAL_MARGIN2 >= vlBeta) {
+      return ecs.vl - EVAL_MARGIN2;
+    }
+    ecs.vl += this->StringHold();
+    ecs.nLevel = 3;
 
   // 3. ͵ۣǣƣ
-  vl += this->StringHold();
-  if (vl + EVAL_MARGIN3 <= vlAlpha) {
-    return vl + EVAL_MARGIN3;
-  } else if (vl - EVAL_MARGIN3 >= vlBeta) {
-    return vl - EVAL_MARGIN3;
-  }
+  case 3:
+    if (ecs.vl + EVAL_MARGIN3 <= vlAlpha) {
+      return ecs.vl + EVAL_MARGIN3;
+    } else if (ecs.vl - EVAL_MARGIN3 >= vlBeta) {
+      return ecs.vl - EVAL_MARGIN3;
+    }
+    ecs.vl += this->RookMobility();
+    ecs.nLevel = 4;
 
   // 4. һ͵ۣԣ
-  vl += this->RookMobility();
-  if (vl + EVAL_MARGIN4 <= vlAlpha) {
-    return vl + EVAL_MARGIN4;
-  } else if (vl - EVAL_MARGIN4 >= vlBeta) {
-    return vl - EVAL_MARGIN4;
-  }
+  case 4:
+    if (ecs.vl + EVAL_MARGIN4 <= vlAlpha) {
+      return ecs.vl + EVAL_MARGIN4;
+    } else if (ecs.vl - EVAL_MARGIN4 >= vlBeta) {
+      return ecs.vl - EVAL_MARGIN4;
+    }
+    ecs.vl += this->KnightTrap();
+    ecs.nLevel = 5;
 
   // 5. 㼶͵(ȫ)谭
-  return vl + this->KnightTrap();
+  default:
+    return ecs.vl;
+  }
 }
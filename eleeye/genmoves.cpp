@@ -171,19 +171,286 @@ bool PositionStruct::Protected(int sd, int sqSrc, int sqExcept) const {
  * MVVֵ"SIMPLE_VALUE"ǰ˧()=5=4=3()=2(ʿ)()=1趨ģ
  * LVAֱֵڳŷС
  */
-int PositionStruct::MvvLva(int sqDst, int pcCaptured, int nLva) const {
+template <int sd> int PositionStruct::MvvLva(int sqDst, int pcCaptured, int nLva) const {
   int nMvv, nLvaAdjust;
   nMvv = SIMPLE_VALUE(pcCaptured);
-  nLvaAdjust = (Protected(OPP_SIDE(sdPlayer), sqDst) ? nLva : 0);
+  nLvaAdjust = (Protected(OPP_SIDE(sd), sqDst) ? nLva : 0);
   if (nMvv >= nLvaAdjust) {
     return nMvv - nLvaAdjust + 1;
   } else {
-    return (nMvv >= 3 || HOME_HALF(sqDst, sdPlayer)) ? 1 : 0;
+    return (nMvv >= 3 || HOME_HALF(sqDst, sd)) ? 1 : 0;
   }
 }
 
+// ̬ʹõӼֵ趨ӱ()ļֵӱ˧()ļֵ󵽳Եֲһ
+static const int cnSeeValues[7] = {1000, 20, 20, 40, 90, 45, 10};
+
+inline int SEE_VALUE(int pc, int sq) {
+  int pt;
+  pt = PIECE_TYPE(pc);
+  return pt == PAWN_TYPE && AWAY_HALF(sq, pc < 32 ? 0 : 1) ? cnSeeValues[pt] * 2 : cnSeeValues[pt];
+}
+
+// ҵĳĳСֵӣظڵĸӣûй򷵻
+int PositionStruct::LeastAttacker(int sd, int sqDst) const {
+  // "Protected()"һǰжȡۺڼܣӼֵСμ
+  int i, sqSrc, pc, x, y, nSideTag;
+  SlideMaskStruct *lpsmsRank, *lpsmsFile;
+
+  __ASSERT_SQUARE(sqDst);
+  nSideTag = SIDE_TAG(sd);
+
+  // 1. ()Ӻ󻹿Ժ򹥻
+  sqSrc = SQUARE_BACKWARD(sqDst, sd);
+  pc = ucpcSquares[sqSrc];
+  if ((pc & nSideTag) != 0 && PIECE_INDEX(pc) >= PAWN_FROM) {
+    return sqSrc;
+  }
+  if (AWAY_HALF(sqDst, sd)) {
+    for (sqSrc = sqDst - 1; sqSrc <= sqDst + 1; sqSrc += 2) {
+      pc = ucpcSquares[sqSrc];
+      if ((pc & nSideTag) != 0 && PIECE_INDEX(pc) >= PAWN_FROM) {
+        return sqSrc;
+      }
+    }
+  } else {
+
+    // 2. (ʿ)
+    if (IN_FORT(sqDst)) {
+      for (i = ADVISOR_FROM; i <= ADVISOR_TO; i ++) {
+        sqSrc = ucsqPieces[nSideTag + i];
+        if (sqSrc != 0 && ADVISOR_SPAN(sqSrc, sqDst)) {
+          return sqSrc;
+        }
+      }
+    }
+
+    // 3. ()۲ܱס
+    for (i = BISHOP_FROM; i <= BISHOP_TO; i ++) {
+      sqSrc = ucsqPieces[nSideTag + i];
+      if (sqSrc != 0 && BISHOP_SPAN(sqSrc, sqDst) && ucpcSquares[BISHOP_PIN(sqSrc, sqDst)] == 0) {
+        return sqSrc;
+      }
+    }
+  }
+
+  // 4. Ȳܱס
+  for (i = KNIGHT_FROM; i <= KNIGHT_TO; i ++) {
+    sqSrc = ucsqPieces[nSideTag + i];
+    if (sqSrc != 0) {
+      __ASSERT_SQUARE(sqSrc);
+      pc = KNIGHT_PIN(sqSrc, sqDst);
+      if (pc != sqSrc && ucpcSquares[pc] == 0) {
+        return sqSrc;
+      }
+    }
+  }
+
+  x = FILE_X(sqDst);
+  y = RANK_Y(sqDst);
+  lpsmsRank = RankMaskPtr(x, y);
+  lpsmsFile = FileMaskPtr(x, y);
+
+  // 5. ڣøһڼ
+  for (i = CANNON_FROM; i <= CANNON_TO; i ++) {
+    sqSrc = ucsqPieces[nSideTag + i];
+    if (sqSrc != 0 && sqSrc != sqDst) {
+      if (x == FILE_X(sqSrc)) {
+        if ((lpsmsFile->wCannonCap & PreGen.wBitFileMask[sqSrc]) != 0) {
+          return sqSrc;
+        }
+      } else if (y == RANK_Y(sqSrc)) {
+        if ((lpsmsRank->wCannonCap & PreGen.wBitRankMask[sqSrc]) != 0) {
+          return sqSrc;
+        }
+      }
+    }
+  }
+
+  // 6. 
+  for (i = ROOK_FROM; i <= ROOK_TO; i ++) {
+    sqSrc = ucsqPieces[nSideTag + i];
+    if (sqSrc != 0 && sqSrc != sqDst) {
+      if (x == FILE_X(sqSrc)) {
+        if ((lpsmsFile->wRookCap & PreGen.wBitFileMask[sqSrc]) != 0) {
+          return sqSrc;
+        }
+      } else if (y == RANK_Y(sqSrc)) {
+        if ((lpsmsRank->wRookCap & PreGen.wBitRankMask[sqSrc]) != 0) {
+          return sqSrc;
+        }
+      }
+    }
+  }
+
+  // 7. ˧()
+  sqSrc = ucsqPieces[nSideTag + KING_FROM];
+  if (sqSrc != 0 && IN_FORT(sqDst) && KING_SPAN(sqSrc, sqDst)) {
+    return sqSrc;
+  }
+  return 0;
+}
+
+/* ̬(SEE)˫СֵĿ϶һӷĵʧ("cnSeeValues"ļֵ)
+ *
+ * һʵؽУÿһӣжȡۺڼܣڼܵͳڵġ򡱶ȷ
+ * ǱǣƵӺ˧()İȫ˽ֻǸֵԿĳŷ
+ */
+int PositionStruct::See(int mv) const {
+  int i, nDepth, sd, sqSrc, sqDst, vlWhiteOld, vlBlackOld, vlOnSquare;
+  int nGain[32], mvSwap[32], pcSwap[32];
+  ZobristStruct zobrOld;
+  // ̻ڶһԭԱΪ"const""posMutable"е"const"Ľɫ
+  PositionStruct &posMutable = (PositionStruct &) *this;
+  // ̬۰¼裺
+
+  // 1. Zobristֵֵƶǻı
+  sqDst = DST(mv);
+  __ASSERT(SRC(mv) != sqDst);
+  __ASSERT_PIECE(ucpcSquares[sqDst]);
+  zobrOld = this->zobr;
+  vlWhiteOld = this->vlWhite;
+  vlBlackOld = this->vlBlack;
+
+  // 2. ߵһŷ
+  nGain[0] = SEE_VALUE(ucpcSquares[sqDst], sqDst);
+  vlOnSquare = SEE_VALUE(ucpcSquares[SRC(mv)], sqDst);
+  mvSwap[0] = mv;
+  pcSwap[0] = posMutable.MovePiece(mv);
+  nDepth = 1;
+  sd = OPP_SIDE(sdPlayer);
+
+  // 3. ˫СֵӳԻأ˫Ѳܴл棬Ͳٳȥ
+  while (nDepth < 32) {
+    sqSrc = LeastAttacker(sd, sqDst);
+    if (sqSrc == 0) {
+      break;
+    }
+    nGain[nDepth] = vlOnSquare - nGain[nDepth - 1];
+    if (MAX(-nGain[nDepth - 1], nGain[nDepth]) < 0) {
+      break;
+    }
+    vlOnSquare = SEE_VALUE(ucpcSquares[sqSrc], sqDst);
+    mvSwap[nDepth] = MOVE(sqSrc, sqDst);
+    pcSwap[nDepth] = posMutable.MovePiece(mvSwap[nDepth]);
+    nDepth ++;
+    sd = OPP_SIDE(sd);
+  }
+
+  // 4. ԭ̡Zobristֵֵ
+  for (i = nDepth - 1; i >= 0; i --) {
+    posMutable.UndoMovePiece(mvSwap[i], pcSwap[i]);
+  }
+  posMutable.zobr = zobrOld;
+  posMutable.vlWhite = vlWhiteOld;
+  posMutable.vlBlack = vlBlackOld;
+
+  // 5. ӶһеĩصƣÿһѡڶԼʱֹͣһ
+  for (i = nDepth - 1; i > 0; i --) {
+    nGain[i - 1] = -MAX(-nGain[i - 1], nGain[i]);
+  }
+  return nGain[0];
+}
+
+#ifdef BITBOARD
+
+// ĳ(Ŀû)ߵԵĸӣֻӵĿ
+inline BitBoardStruct PieceAttacks(const PositionStruct &pos, int pc, int sq) {
+  switch (PIECE_INDEX(pc)) {
+  case KING_FROM:
+    return PreGen.bbKingMoves[sq];
+  case ADVISOR_FROM:
+  case ADVISOR_TO:
+    return PreGen.bbAdvisorMoves[sq];
+  case BISHOP_FROM:
+  case BISHOP_TO:
+    return pos.BishopAttacks(sq);
+  case KNIGHT_FROM:
+  case KNIGHT_TO:
+    return pos.KnightAttacks(sq);
+  case ROOK_FROM:
+  case ROOK_TO:
+    return pos.RookAttacks(sq);
+  case CANNON_FROM:
+  case CANNON_TO:
+    return pos.CannonAttacks(sq);
+  default:
+    return PreGen.bbPawnMoves[pc < 32 ? 0 : 1][sq];
+  }
+}
+
+// ŷ(λ̰汾)MVV(LVA)趨ֵ
+template <int sd> int PositionStruct::GenCapMovesSide(MoveStruct *lpmvs) const {
+  int i, pc, sqSrc, sqDst, nSideTag;
+  bool bCanPromote;
+  BitBoardStruct bbDst;
+  MoveStruct *lpmvsCurr;
+  // ˧ڱ˳ÿӵĳŷ
+
+  lpmvsCurr = lpmvs;
+  nSideTag = SIDE_TAG(sd);
+  bCanPromote = lpPreEval->bPromotion && CanPromote();
+  for (i = 0; i < 16; i ++) {
+    pc = nSideTag + i;
+    sqSrc = ucsqPieces[pc];
+    if (sqSrc != 0) {
+      __ASSERT_SQUARE(sqSrc);
+      // 1. ܳԵĸӺͶԷӵλ룬͵õгӵĿ
+      bbDst = PieceAttacks(*this, pc, sqSrc) & bbSides[OPP_SIDE(sd)];
+      // 2. ȡĿLVAֵӵļ򵥷ֵ
+      while (!bbDst.IsZero()) {
+        sqDst = BB_SQUARE(bbDst.PopLsb());
+        __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
+        lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
+        lpmvsCurr->wvl = MvvLva<sd>(sqDst, ucpcSquares[sqDst], SIMPLE_VALUE(pc));
+        lpmvsCurr ++;
+      }
+      // 3. (ʿ)()ڵϻ䡣
+      if (bCanPromote && i >= ADVISOR_FROM && i <= BISHOP_TO && CAN_PROMOTE(sqSrc)) {
+        lpmvsCurr->wmv = MOVE(sqSrc, sqSrc);
+        lpmvsCurr->wvl = 0;
+        lpmvsCurr ++;
+      }
+    }
+  }
+  return lpmvsCurr - lpmvs;
+}
+
+// ŷ(λ̰汾)
+template <int sd> int PositionStruct::GenNonCapMovesSide(MoveStruct *lpmvs) const {
+  int i, pc, sqSrc, nSideTag;
+  BitBoardStruct bbOccupied, bbDst;
+  MoveStruct *lpmvsCurr;
+
+  lpmvsCurr = lpmvs;
+  nSideTag = SIDE_TAG(sd);
+  bbOccupied = Occupied();
+  for (i = 0; i < 16; i ++) {
+    pc = nSideTag + i;
+    sqSrc = ucsqPieces[pc];
+    if (sqSrc != 0) {
+      __ASSERT_SQUARE(sqSrc);
+      // ֱòӵԤ飬ӵĿҪȥӵĸ
+      if (i >= ROOK_FROM && i <= CANNON_TO) {
+        bbDst = SlideNonCaps(sqSrc);
+      } else {
+        bbDst = PieceAttacks(*this, pc, sqSrc).AndNot(bbOccupied);
+      }
+      while (!bbDst.IsZero()) {
+        lpmvsCurr->dwmv = MOVE(sqSrc, BB_SQUARE(bbDst.PopLsb()));
+        __ASSERT(ucpcSquares[DST(lpmvsCurr->wmv)] == 0);
+        __ASSERT(LegalMove(lpmvsCurr->wmv));
+        lpmvsCurr ++;
+      }
+    }
+  }
+  return lpmvsCurr - lpmvs;
+}
+
+#else
+
 // ŷMVV(LVA)趨ֵ
-int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
+template <int sd> int PositionStruct::GenCapMovesSide(MoveStruct *lpmvs) const {
   int i, sqSrc, sqDst, pcCaptured;
   int x, y, nSideTag, nOppSideTag;
   bool bCanPromote;
@@ -193,9 +460,9 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
   // ɳŷĹ̰¼裺
 
   lpmvsCurr = lpmvs;
-  nSideTag = SIDE_TAG(sdPlayer);
-  nOppSideTag = OPP_SIDE_TAG(sdPlayer);
-  bCanPromote = PreEval.bPromotion && CanPromote();
+  nSideTag = SIDE_TAG(sd);
+  nOppSideTag = OPP_SIDE_TAG(sd);
+  bCanPromote = lpPreEval->bPromotion && CanPromote();
 
   // 1. ˧()ŷ
   sqSrc = ucsqPieces[nSideTag + KING_FROM];
@@ -211,7 +478,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
       if ((pcCaptured & nOppSideTag) != 0) {
         __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
         lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-        lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 5); // ˧()ļֵ5
+        lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 5); // ˧()ļֵ5
         lpmvsCurr ++;
       }
       lpucsqDst ++;
@@ -232,7 +499,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 1); // (ʿ)ļֵ1
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 1); // (ʿ)ļֵ1
           lpmvsCurr ++;
         }
         lpucsqDst ++;
@@ -261,7 +528,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
           if ((pcCaptured & nOppSideTag) != 0) {
             __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
             lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-            lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 1); // ()ļֵ1
+            lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 1); // ()ļֵ1
             lpmvsCurr ++;
           }
         }
@@ -292,7 +559,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
           if ((pcCaptured & nOppSideTag) != 0) {
             __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
             lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-            lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 3); // ļֵ3
+            lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 3); // ļֵ3
             lpmvsCurr ++;
           }
         }
@@ -319,7 +586,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 4); // ļֵ4
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 4); // ļֵ4
           lpmvsCurr ++;
         }
       }
@@ -330,7 +597,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 4); // ļֵ4
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 4); // ļֵ4
           lpmvsCurr ++;
         }
       }
@@ -343,7 +610,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 4); // ļֵ4
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 4); // ļֵ4
           lpmvsCurr ++;
         }
       }
@@ -354,7 +621,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 4); // ļֵ4
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 4); // ļֵ4
           lpmvsCurr ++;
         }
       }
@@ -377,7 +644,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 3); // ڵļֵ3
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 3); // ڵļֵ3
           lpmvsCurr ++;
         }
       }
@@ -388,7 +655,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 3); // ڵļֵ3
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 3); // ڵļֵ3
           lpmvsCurr ++;
         }
       }
@@ -401,7 +668,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 3); // ڵļֵ3
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 3); // ڵļֵ3
           lpmvsCurr ++;
         }
       }
@@ -412,7 +679,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 3); // ڵļֵ3
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 3); // ڵļֵ3
           lpmvsCurr ++;
         }
       }
@@ -424,7 +691,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
     sqSrc = ucsqPieces[nSideTag + i];
     if (sqSrc != 0) {
       __ASSERT_SQUARE(sqSrc);
-      lpucsqDst = PreGen.ucsqPawnMoves[sdPlayer][sqSrc];
+      lpucsqDst = PreGen.ucsqPawnMoves[sd][sqSrc];
       sqDst = *lpucsqDst;
       while (sqDst != 0) {
         __ASSERT_SQUARE(sqDst);
@@ -432,7 +699,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
         if ((pcCaptured & nOppSideTag) != 0) {
           __ASSERT(LegalMove(MOVE(sqSrc, sqDst)));
           lpmvsCurr->wmv = MOVE(sqSrc, sqDst);
-          lpmvsCurr->wvl = MvvLva(sqDst, pcCaptured, 2); // ()ļֵ2
+          lpmvsCurr->wvl = MvvLva<sd>(sqDst, pcCaptured, 2); // ()ļֵ2
           lpmvsCurr ++;
         }
         lpucsqDst ++;
@@ -444,7 +711,7 @@ int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
 }
 
 // ŷ
-int PositionStruct::GenNonCapMoves(MoveStruct *lpmvs) const {
+template <int sd> int PositionStruct::GenNonCapMovesSide(MoveStruct *lpmvs) const {
   int i, sqSrc, sqDst, x, y, nSideTag;
   SlideMoveStruct *lpsmv;
   uint8_t *lpucsqDst, *lpucsqPin;
@@ -452,7 +719,7 @@ int PositionStruct::GenNonCapMoves(MoveStruct *lpmvs) const {
   // ɲŷĹ̰¼裺
 
   lpmvsCurr = lpmvs;
-  nSideTag = SIDE_TAG(sdPlayer);
+  nSideTag = SIDE_TAG(sd);
 
   // 1. ˧()ŷ
   sqSrc = ucsqPieces[nSideTag + KING_FROM];
@@ -592,7 +859,7 @@ int PositionStruct::GenNonCapMoves(MoveStruct *lpmvs) const {
     sqSrc = ucsqPieces[nSideTag + i];
     if (sqSrc != 0) {
       __ASSERT_SQUARE(sqSrc);
-      lpucsqDst = PreGen.ucsqPawnMoves[sdPlayer][sqSrc];
+      lpucsqDst = PreGen.ucsqPawnMoves[sd][sqSrc];
       sqDst = *lpucsqDst;
       while (sqDst != 0) {
         __ASSERT_SQUARE(sqDst);
@@ -609,6 +876,17 @@ int PositionStruct::GenNonCapMoves(MoveStruct *lpmvs) const {
   return lpmvsCurr - lpmvs;
 }
 
+#endif
+
+// ŷͲŷԺ˫ֱʵÿεֻжһӷ
+int PositionStruct::GenCapMoves(MoveStruct *lpmvs) const {
+  return sdPlayer == 0 ? GenCapMovesSide<0>(lpmvs) : GenCapMovesSide<1>(lpmvs);
+}
+
+int PositionStruct::GenNonCapMoves(MoveStruct *lpmvs) const {
+  return sdPlayer == 0 ? GenNonCapMovesSide<0>(lpmvs) : GenNonCapMovesSide<1>(lpmvs);
+}
+
 // ׽ļ
 int PositionStruct::ChasedBy(int mv) const {
   int i, nSideTag, pcMoved, pcCaptured;
@@ -24,14 +24,135 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
   #include <stdio.h>
 #endif
 #include "../base/base.h"
+#include "../base/base2.h"
 #include "position.h"
 #include "hash.h"
 
-int nHashMask;
-HashStruct *hshItems;
+// ûļļͷռһûͰʹûȻͰ
+union HashFileHeaderStruct {
+  uint8_t ucBuffer[HASH_BUCKET_SIZE];
+  struct {
+    char szMagic[8];                                       // ļʶ"EEHASH01"
+    uint32_t dwZobristKey, dwZobristLock0, dwZobristLock1; // ӷZobristֵZobristֵ(Ӿ)Ƿһ
+    uint32_t dwEntrySize, dwLayers;                        // ûĴСͲ
+    uint32_t dwHashMask;                                   // ûĴС(Ͱ1)
+    uint8_t ucHashAge;                                     // ûĵǰ
+  };
+}; // hfh
+
+// ûռõֽ
+static size_t HashSize(const HashTableStruct &ht) {
+  return ((size_t) ht.dwHashMask + 1) * HASH_BUCKET_SIZE;
+}
+
+// ûС 2^nHashScale ֽڣͰ룬Աÿδȡֻһ
+bool NewHash(HashTableStruct &ht, int nHashScale) {
+  HashStruct *hshItems;
+  uint32_t dwHashMask;
+  __ASSERT(sizeof(HashStruct) * HASH_LAYERS == HASH_BUCKET_SIZE);
+  // 32λϵͳû1Gڴ治ôμ룬1M䲻ͱԭû
+  nHashScale = MIN(nHashScale, (int) sizeof(size_t) * 8 - 2);
+  while (true) {
+    dwHashMask = (uint32_t) (((size_t) 1 << nHashScale) / HASH_BUCKET_SIZE - 1);
+    hshItems = (HashStruct *) LargeAlloc(((size_t) dwHashMask + 1) * HASH_BUCKET_SIZE);
+    if (hshItems != NULL) {
+      break;
+    }
+    if (nHashScale <= 20) {
+      return false;
+    }
+    nHashScale --;
+  }
+  DelHash(ht);
+  ht.dwHashMask = dwHashMask;
+  ht.nHashScale = nHashScale;
+  ht.hshItems = hshItems;
+  ht.ucHashAge = 0;
+#ifdef HASH_QUIESC
+  ht.hshItemsQ = new HashStruct[(size_t) ht.dwHashMask + 1];
+#endif
+  ht.lphfhMapped = NULL;
+  // ·ڴȻѾ㣬һοڴҳǰȫ
+  ClearHash(ht);
+  return true;
+}
+
+// ͷûѾͷŹûͷ
+void DelHash(HashTableStruct &ht) {
+  if (ht.hshItems == NULL) {
+    return;
+  }
+  if (ht.lphfhMapped == NULL) {
+    LargeFree(ht.hshItems, HashSize(ht));
+  } else {
+    UnmapFile(ht.lphfhMapped, sizeof(HashFileHeaderStruct) + HashSize(ht));
+    ht.lphfhMapped = NULL;
+  }
+  ht.hshItems = NULL;
+#ifdef HASH_QUIESC
+  delete[] ht.hshItemsQ;
+#endif
+}
+
+// ߳ûʱÿ߳еһ
+const size_t HASH_CLEAR_SLICE = 1 << 28;
+
+struct HashClearStruct {
+  char *lpBuffer;
+  size_t nSize;
+  volatile bool bDone;
+}; // hcs
+
+static void *ClearHashEntry(void *lpParameter) {
+  HashClearStruct *lphcs = (HashClearStruct *) lpParameter;
+  memset(lphcs->lpBuffer, 0, lphcs->nSize);
+  MemFence();
+  lphcs->bDone = true;
+  return NULL;
+}
+
+// ûܴûֳɼ(ÿ256M)ɶ߳ͬʱ
+void ClearHash(HashTableStruct &ht) {
+  HashClearStruct *lphcs;
+  size_t nSize, nSlice;
+  int i, nThreads;
+
+  nSize = HashSize(ht);
+  nThreads = (int) MIN(nSize / HASH_CLEAR_SLICE, (size_t) GetCpuNum());
+  nThreads = MAX(nThreads, 1);
+  nSlice = nSize / nThreads / HASH_BUCKET_SIZE * HASH_BUCKET_SIZE;
+  lphcs = new HashClearStruct[nThreads];
+  for (i = 0; i < nThreads; i ++) {
+    lphcs[i].lpBuffer = (char *) ht.hshItems + nSlice * i;
+    lphcs[i].nSize = (i == nThreads - 1 ? nSize - nSlice * i : nSlice);
+    lphcs[i].bDone = false;
+  }
+  for (i = 1; i < nThreads; i ++) {
+    StartThread(ClearHashEntry, lphcs + i);
+  }
+  ClearHashEntry(lphcs);
+  for (i = 1; i < nThreads; i ++) {
+    while (!lphcs[i].bDone) {
+      Idle();
+    }
+  }
+  delete[] lphcs;
 #ifdef HASH_QUIESC
-  HashStruct *hshItemsQ;
+  memset(ht.hshItemsQ, 0, ((size_t) ht.dwHashMask + 1) * sizeof(HashStruct));
 #endif
+}
+
+// ûʹ(ǧֱ)ֻͳǰ1000ﱾдй
+int HashFull(const HashTableStruct &ht) {
+  int i, nUsed;
+  nUsed = 0;
+  for (i = 0; i < 1000; i ++) {
+    if (ht.hshItems[i].ucAge == ht.ucHashAge && ht.hshItems[i].dwZobristLock1 != 0) {
+      nUsed ++;
+    }
+  }
+  return nUsed;
+}
 
 // 洢ûϢ
 void RecordHash(const PositionStruct &pos, int nFlag, int vl, int nDepth, int mv) {
@@ -78,14 +199,16 @@ void RecordHash(const PositionStruct &pos, int nFlag, int vl, int nDepth, int mv
       if (mv != 0) {
         hsh.wmv = mv;
       }
+      hsh.ucAge = pos.lpHash->ucHashAge;
       HASH_ITEM(pos, i) = hsh;
       return;
     }
 
-    // 4. һľ棬ôСû
+    // 4. һľ棬ôСûǰµûԽԽȱ滻
     nHashDepth = MAX((hsh.ucAlphaDepth == 0 ? 0 : hsh.ucAlphaDepth + 256),
         (hsh.wmv == 0 ? hsh.ucBetaDepth : hsh.ucBetaDepth + 256));
     __ASSERT(nHashDepth < 512);
+    nHashDepth -= (uint8_t) (pos.lpHash->ucHashAge - hsh.ucAge) * 512;
     if (nHashDepth < nMinDepth) {
       nMinDepth = nHashDepth;
       nMinLayer = i;
@@ -93,7 +216,9 @@ void RecordHash(const PositionStruct &pos, int nFlag, int vl, int nDepth, int mv
   }
 
   // 5. ¼û
-  hsh.dwZobristLock0 = pos.zobr.dwLock0;
+  hsh.wZobristLock0 = pos.zobr.dwLock0;
+  hsh.ucAge = pos.lpHash->ucHashAge;
+  hsh.ucReserved = 0;
   hsh.dwZobristLock1 = pos.zobr.dwLock1;
   hsh.wmv = mv;
   hsh.ucAlphaDepth = hsh.ucBetaDepth = 0;
@@ -182,7 +307,7 @@ static bool PosStable(const PositionStruct &pos, int mv) {
         break;
       }
     }
-    mv = (i == HASH_LAYERS ? 0 : hsh.wmv);
+    mv = (i == HASH_LAYERS || !posMutable.LegalMove(hsh.wmv) ? 0 : hsh.wmv);
   }
   // ǰִйŷ
   for (i = 0; i < nMoveNum; i ++) {
@@ -203,8 +328,15 @@ int ProbeHash(const PositionStruct &pos, int vlAlpha, int vlBeta, int nDepth, bo
   for (i = 0; i < HASH_LAYERS; i ++) {
     hsh = HASH_ITEM(pos, i);
     if (HASH_POS_EQUAL(hsh, pos)) {
+      // ߳ʱû̸ֻ߳дһ룬ŷ
+      if (hsh.wmv != 0 && !pos.LegalMove(hsh.wmv)) {
+        return -MATE_VALUE;
+      }
       mv = hsh.wmv;
-      __ASSERT(mv == 0 || pos.LegalMove(mv));
+      // ǰµûٴУ͸䣬ⱻ滻
+      if (hsh.ucAge != pos.lpHash->ucHashAge) {
+        HASH_ITEM(pos, i).ucAge = pos.lpHash->ucHashAge;
+      }
       break;
     }
   }
@@ -242,8 +374,8 @@ int ProbeHash(const PositionStruct &pos, int vlAlpha, int vlBeta, int nDepth, bo
 void RecordHashQ(const PositionStruct &pos, int vlBeta, int vlAlpha) {
   volatile HashStruct *lphsh;
   __ASSERT((vlBeta > -WIN_VALUE && vlBeta < WIN_VALUE) || (vlAlpha > -WIN_VALUE && vlAlpha < WIN_VALUE));
-  lphsh = hshItemsQ + (pos.zobr.dwKey & nHashMask);
-  lphsh->dwZobristLock0 = pos.zobr.dwLock0;
+  lphsh = pos.lpHash->hshItemsQ + (pos.zobr.dwKey & pos.lpHash->dwHashMask);
+  lphsh->wZobristLock0 = pos.zobr.dwLock0;
   lphsh->svlAlpha = vlAlpha;
   lphsh->svlBeta = vlBeta;
   lphsh->dwZobristLock1 = pos.zobr.dwLock1;
@@ -254,8 +386,8 @@ int ProbeHashQ(const PositionStruct &pos, int vlAlpha, int vlBeta) {
   volatile HashStruct *lphsh;
   int vlHashAlpha, vlHashBeta;
 
-  lphsh = hshItemsQ + (pos.zobr.dwKey & nHashMask);
-  if (lphsh->dwZobristLock0 == pos.zobr.dwLock0) {
+  lphsh = pos.lpHash->hshItemsQ + (pos.zobr.dwKey & pos.lpHash->dwHashMask);
+  if (lphsh->wZobristLock0 == (uint16_t) pos.zobr.dwLock0) {
     vlHashAlpha = lphsh->svlAlpha;
     vlHashBeta = lphsh->svlBeta;
     if (lphsh->dwZobristLock1 == pos.zobr.dwLock1) {
@@ -276,6 +408,93 @@ int ProbeHashQ(const PositionStruct &pos, int vlAlpha, int vlBeta) {
 
 #ifndef CCHESS_A3800
 
+static const char *const cszHashFileMagic = "EEHASH01";
+
+// õǰûûļļͷ
+static void BuildHashFileHeader(HashFileHeaderStruct &hfh, const HashTableStruct &ht) {
+  memset(&hfh, 0, sizeof(HashFileHeaderStruct));
+  memcpy(hfh.szMagic, cszHashFileMagic, 8);
+  hfh.dwZobristKey = PreGen.zobrPlayer.dwKey;
+  hfh.dwZobristLock0 = PreGen.zobrPlayer.dwLock0;
+  hfh.dwZobristLock1 = PreGen.zobrPlayer.dwLock1;
+  hfh.dwEntrySize = sizeof(HashStruct);
+  hfh.dwLayers = HASH_LAYERS;
+  hfh.dwHashMask = ht.dwHashMask;
+  hfh.ucHashAge = ht.ucHashAge;
+}
+
+// ӳûļļͷ(ɲͬ汾ĳ򱣴)ʱ"false"ԭû
+bool LoadHash(HashTableStruct &ht, const char *szFileName) {
+  HashFileHeaderStruct *lphfh;
+  size_t nSize;
+
+  lphfh = (HashFileHeaderStruct *) MapFile(szFileName, nSize);
+  if (lphfh == NULL) {
+    return false;
+  }
+  if (nSize < sizeof(HashFileHeaderStruct) || memcmp(lphfh->szMagic, cszHashFileMagic, 8) != 0 ||
+      lphfh->dwZobristKey != PreGen.zobrPlayer.dwKey || lphfh->dwZobristLock0 != PreGen.zobrPlayer.dwLock0 ||
+      lphfh->dwZobristLock1 != PreGen.zobrPlayer.dwLock1 || lphfh->dwEntrySize != sizeof(HashStruct) ||
+      lphfh->dwLayers != HASH_LAYERS || nSize != sizeof(HashFileHeaderStruct) +
+      ((size_t) lphfh->dwHashMask + 1) * HASH_BUCKET_SIZE) {
+    UnmapFile(lphfh, nSize);
+    return false;
+  }
+  DelHash(ht);
+  ht.lphfhMapped = lphfh;
+  ht.dwHashMask = lphfh->dwHashMask;
+  ht.nHashScale = 0;
+  while (((size_t) 1 << ht.nHashScale) < HashSize(ht)) {
+    ht.nHashScale ++;
+  }
+  ht.hshItems = (HashStruct *) (lphfh + 1);
+  ht.ucHashAge = lphfh->ucHashAge;
+#ifdef HASH_QUIESC
+  ht.hshItemsQ = new HashStruct[(size_t) ht.dwHashMask + 1];
+  memset(ht.hshItemsQ, 0, ((size_t) ht.dwHashMask + 1) * sizeof(HashStruct));
+#endif
+  return true;
+}
+
+// ûļдʱļٸдʧʱƻԭļ
+bool SaveHash(HashTableStruct &ht, const char *szFileName) {
+  HashFileHeaderStruct hfh;
+  FILE *fp;
+  char szTempFile[PATH_MAX_CHAR];
+  int nHashScale;
+  bool bSucc;
+
+  if (strlen(szFileName) + 5 > PATH_MAX_CHAR) {
+    return false;
+  }
+  sprintf(szTempFile, "%s.tmp", szFileName);
+  fp = fopen(szTempFile, "wb");
+  if (fp == NULL) {
+    return false;
+  }
+  BuildHashFileHeader(hfh, ht);
+  bSucc = fwrite(&hfh, sizeof(HashFileHeaderStruct), 1, fp) == 1 &&
+      fwrite(ht.hshItems, HASH_BUCKET_SIZE, (size_t) ht.dwHashMask + 1, fp) == (size_t) ht.dwHashMask + 1;
+  bSucc = (fclose(fp) == 0 && bSucc);
+  if (!bSucc) {
+    remove(szTempFile);
+    return false;
+  }
+  if (ht.lphfhMapped == NULL) {
+    return RenameFile(szTempFile, szFileName);
+  }
+  // ûѾӳ䵽ļʱ(Windows²滻ӳļ)Ҫͷӳ䣬ӳļݾԭû
+  // ӳ䲻ʱԭĴС·("NewHash()"䲻ʱμ룬ֱ1M)䲻һ64Kû
+  // ʱԭûѾͷˣû
+  nHashScale = ht.nHashScale;
+  DelHash(ht);
+  bSucc = RenameFile(szTempFile, szFileName);
+  if (!LoadHash(ht, bSucc ? szFileName : szTempFile) && !NewHash(ht, nHashScale) && !NewHash(ht, 16)) {
+    return false;
+  }
+  return bSucc;
+}
+
 // UCCI֧ - HashеľϢ
 bool PopHash(const PositionStruct &pos) {
   HashStruct hsh;
@@ -286,8 +505,8 @@ bool PopHash(const PositionStruct &pos) {
     hsh = HASH_ITEM(pos, i);
     if (HASH_POS_EQUAL(hsh, pos)) {
       printf("pophash");
-      if (hsh.wmv != 0) {
-        __ASSERT(pos.LegalMove(hsh.wmv));
+      // ûļҲУͬ棬ŷҪ"ProbeHash()"һ
+      if (hsh.wmv != 0 && pos.LegalMove(hsh.wmv)) {
         dwMoveStr = MOVE_COORD(hsh.wmv);
         printf(" bestmove %.4s", (const char *) &dwMoveStr);
       }
@@ -32,59 +32,61 @@ const int HASH_BETA = 1;
 const int HASH_ALPHA = 2;
 const int HASH_PV = HASH_ALPHA | HASH_BETA;
 
-const int HASH_LAYERS = 2;   // ûĲ
+const int HASH_LAYERS = 4;   // ûĲͬһͰ4ռһ
 const int NULL_DEPTH = 2;    // Ųü
 
 // ûṹûϢZobristУм䣬Էֹȡͻ
 struct HashStruct {
-  uint32_t dwZobristLock0;           // ZobristУһ
+  uint16_t wZobristLock0;            // ZobristУһ(ֻ16λ)
+  uint8_t ucAge, ucReserved;         // (дʱ)ֽ
   uint16_t wmv;                      // ŷ
   uint8_t ucAlphaDepth, ucBetaDepth; // (ϱ߽±߽)
   int16_t svlAlpha, svlBeta;         // ֵ(ϱ߽±߽)
   uint32_t dwZobristLock1;           // ZobristУڶ
 }; // hsh
 
-// ûϢ
-extern int nHashMask;              // ûĴС
-extern HashStruct *hshItems;       // ûָ룬ElephantEyeöû
-#ifdef HASH_QUIESC
-  extern HashStruct *hshItemsQ;
-#endif
+const int HASH_BUCKET_SIZE = 64; // ûͰĴСһ
 
-inline void ClearHash(void) {         // û
-  memset(hshItems, 0, (nHashMask + 1) * sizeof(HashStruct));
-#ifdef HASH_QUIESC
-  memset(hshItemsQ, 0, (nHashMask + 1) * sizeof(HashStruct));
-#endif
-}
+union HashFileHeaderStruct;
 
-inline void NewHash(int nHashScale) { // ûС 2^nHashScale ֽ
-  nHashMask = ((1 << nHashScale) / sizeof(HashStruct)) - 1;
-  hshItems = new HashStruct[nHashMask + 1];
+// ûÿʵиԵû("search.h")ͨ"lpHash"ָ
+struct HashTableStruct {
+  uint32_t dwHashMask;               // ûĴС(Ͱ1)
+  int nHashScale;                    // ûĴС 2^nHashScale ֽڣӳ䵽ļҪ·ʱ
+  HashStruct *hshItems;              // ûָ룬ElephantEyeöû㰴Ͱ
+  uint8_t ucHashAge;                 // ûĵǰ䣬ÿ1ͬûȱ滻
 #ifdef HASH_QUIESC
-  hshItemsQ = new HashStruct[nHashMask + 1];
+  HashStruct *hshItemsQ;
 #endif
-  ClearHash();
-}
+  HashFileHeaderStruct *lphfhMapped; // ûӳ䵽ļʱָļͷΪNULL
+}; // ht
 
-inline void DelHash(void) {           // ͷû
-  delete[] hshItems;
-#ifdef HASH_QUIESC
-  delete[] hshItemsQ;
-#endif
+inline void NewHashAge(HashTableStruct &ht) { // ʼµûеϢ
+  ht.ucHashAge ++;
 }
 
 // жûǷϾ(ZobristǷ)
 inline bool HASH_POS_EQUAL(const HashStruct &hsh, const PositionStruct &pos) {
-  return hsh.dwZobristLock0 == pos.zobr.dwLock0 && hsh.dwZobristLock1 == pos.zobr.dwLock1;
+  return hsh.wZobristLock0 == (uint16_t) pos.zobr.dwLock0 && hsh.dwZobristLock1 == pos.zobr.dwLock1;
 }
 
-// Ͳȡû(һãԶ丳ֵ)
+// Ͳȡû(һãԶ丳ֵ)ͬһĸ㶼һͰ
 inline HashStruct &HASH_ITEM(const PositionStruct &pos, int nLayer) {
-  return hshItems[(pos.zobr.dwKey + nLayer) & nHashMask];
+  return pos.lpHash->hshItems[(size_t) (pos.zobr.dwKey & pos.lpHash->dwHashMask) * HASH_LAYERS + nLayer];
+}
+
+// ûԤȡûָûʱԤȡ
+inline void PrefetchHash(const PositionStruct &pos) {
+  if (pos.lpHash != NULL) {
+    Prefetch(&HASH_ITEM(pos, 0));
+  }
 }
 
 // ûĹ
+bool NewHash(HashTableStruct &ht, int nHashScale); // ûС 2^nHashScale ֽڣ䲻ʱԭû䣬"false"
+void DelHash(HashTableStruct &ht);                 // ͷû(ûзû"hshItems"ΪNULL)
+void ClearHash(HashTableStruct &ht);               // ûܴûö߳
+int HashFull(const HashTableStruct &ht);           // ûʹ(ǧֱ)ֻͳǰ1000ﱾд
 void RecordHash(const PositionStruct &pos, int nFlag, int vl, int nDepth, int mv);                    // 洢ûϢ
 int ProbeHash(const PositionStruct &pos, int vlAlpha, int vlBeta, int nDepth, bool bNoNull, int &mv); // ȡûϢ
 #ifdef HASH_QUIESC
@@ -93,6 +95,9 @@ int ProbeHash(const PositionStruct &pos, int vlAlpha, int vlBeta, int nDepth, bo
 #endif
 
 #ifndef CCHESS_A3800
+  // ûļ˳ʱû´ʱӳ
+  bool LoadHash(HashTableStruct &ht, const char *szFileName); // ӳûļ
+  bool SaveHash(HashTableStruct &ht, const char *szFileName); // ûļ
   // UCCI֧ - HashеľϢ
   bool PopHash(const PositionStruct &pos);
 #endif
@@ -24,15 +24,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "position.h"
 #include "movesort.h"
 
-int nHistory[65536]; // ʷ
-
 // ʷŷбֵ
 void MoveSortStruct::SetHistory(void) {
   int i, j, vl, nShift, nNewShift;
   nShift = 0;
   for (i = nMoveIndex; i < nMoveNum; i ++) {
     // ŷķֵ65536ͱŷķֵʹǶ65536
-    vl = nHistory[mvs[i].wmv] >> nShift;
+    vl = lpnHistory[mvs[i].wmv] >> nShift;
     if (vl > 65535) {
       nNewShift = Bsr(vl) - 15;
       for (j = nMoveIndex; j < i; j ++) {
@@ -46,6 +44,21 @@ void MoveSortStruct::SetHistory(void) {
   }
 }
 
+/* þֳ̬ŷĺû
+ *
+ * MVV(LVA)ֵ1ĳŷϾ׬ģ0ĳŷûмֵжϣ
+ * ֻMVV(LVA)ֵ1ĳŷ(бӼֵ)Ҫþ̬жϣ
+ * ĳŷᵽ2׬ĳŷһĳŷ0̬ٿǡ
+ */
+void MoveSortStruct::SetSee(const PositionStruct &pos) {
+  int i;
+  for (i = nMoveIndex; i < nMoveNum; i ++) {
+    if (mvs[i].wvl == 1) {
+      mvs[i].wvl = (pos.See(mvs[i].wmv) >= 0 ? 2 : 0);
+    }
+  }
+}
+
 // Shell򷨣"1, 4, 13, 40 ..."УҪ"1, 2, 4, 8, ..."
 static const int cnShellStep[8] = {0, 1, 4, 13, 40, 121, 364, 1093};
 
@@ -80,9 +93,10 @@ void MoveSortStruct::ShellSort(void) {
  * 3. ŷʷ(1SORT_VALUE_MAX - 3)
  * 4. ܽ⽫ŷ(0)Щŷ˵
  */
-int MoveSortStruct::InitEvade(PositionStruct &pos, int mv, const uint16_t *lpwmvKiller) {
+int MoveSortStruct::InitEvade(PositionStruct &pos, int mv, const uint16_t *lpwmvKiller, const int *lpnHistoryTab) {
   int i, nLegal;
   nPhase = PHASE_REST;
+  lpnHistory = lpnHistoryTab;
   nMoveIndex = 0;
   nMoveNum = pos.GenAllMoves(mvs);
   SetHistory();
@@ -129,12 +143,13 @@ int MoveSortStruct::NextFull(const PositionStruct &pos) {
     nPhase = PHASE_GOODCAP;
     nMoveIndex = 0;
     nMoveNum = pos.GenCapMoves(mvs);
+    SetSee(pos);
     ShellSort();
 
   // 2. MVV(LVA)ҪѭɴΣ
   case PHASE_GOODCAP:
     if (nMoveIndex < nMoveNum && mvs[nMoveIndex].wvl > 1) {
-      // ע⣺MVV(LVA)ֵ1˵ӲֱܻƵģЩŷԺ
+      // ע⣺MVV(LVA)ֵ1˵ǿ("SetSee()")ûмֵЩŷԺ
       nMoveIndex ++;
       __ASSERT_PIECE(pos.ucpcSquares[DST(mvs[nMoveIndex - 1].wmv)]);
       return mvs[nMoveIndex - 1].wmv;
@@ -195,12 +210,12 @@ void MoveSortStruct::InitRoot(const PositionStruct &pos, int nBanMoves, const ui
   nMoveNum -= nBanned;
 }
 
-// ¸ŷб
-void MoveSortStruct::UpdateRoot(int mv) {
+// ¸ŷбҪģʽ£ǰ漸Ҫŷԭ˳
+void MoveSortStruct::UpdateRoot(int mv, int nPvIndex) {
   int i;
-  for (i = 0; i < nMoveNum; i ++) {
+  for (i = nPvIndex; i < nMoveNum; i ++) {
     if (mvs[i].wmv == mv) {
-      mvs[i].wvl = SORT_VALUE_MAX;
+      mvs[i].wvl = SORT_VALUE_MAX - nPvIndex;
     } else if (mvs[i].wvl > 0) {
       mvs[i].wvl --;      
     }
@@ -29,12 +29,10 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 const int LIMIT_DEPTH = 64;       // ļ
 const int SORT_VALUE_MAX = 65535; // ŷֵ
+const int HISTORY_SIZE = 65536;   // ʷĳ
 
 extern const int FIBONACCI_LIST[32];
 
-// "nHistory"ֻ"movesort.cpp"һģʹ
-extern int nHistory[65536]; // ʷ
-
 // ŷ˳ɽ׶("NextFull()")
 const int PHASE_HASH = 0;
 const int PHASE_GEN_CAP = 1;
@@ -51,9 +49,11 @@ const bool ROOT_UNIQUE = true; // 
 struct MoveSortStruct {
   int nPhase, nMoveIndex, nMoveNum;
   int mvHash, mvKiller1, mvKiller2;
+  const int *lpnHistory; // ʷÿ߳иԵʷ
   MoveStruct mvs[MAX_GEN_MOVES];
 
   void SetHistory(void); // ʷŷбֵ
+  void SetSee(const PositionStruct &pos); // þֳ̬ŷĺû
   void ShellSort(void);  // ŷ
   // õĳŷ(ûŷʷɱŷ)
   bool GoodCap(const PositionStruct &pos, int mv) {
@@ -61,7 +61,8 @@ struct MoveSortStruct {
   }
 
   // ̬ŷ˳
-  void InitAll(const PositionStruct &pos) {
+  void InitAll(const PositionStruct &pos, const int *lpnHistoryTab) {
+    lpnHistory = lpnHistoryTab;
     nMoveIndex = 0;
     nMoveNum = pos.GenAllMoves(mvs);
     SetHistory();
@@ -70,9 +71,11 @@ struct MoveSortStruct {
   void InitQuiesc(const PositionStruct &pos) {
     nMoveIndex = 0;
     nMoveNum = pos.GenCapMoves(mvs);
+    SetSee(pos);
     ShellSort();
   }
-  void InitQuiesc2(const PositionStruct &pos) {
+  void InitQuiesc2(const PositionStruct &pos, const int *lpnHistoryTab) {
+    lpnHistory = lpnHistoryTab;
     nMoveNum += pos.GenNonCapMoves(mvs);
     SetHistory();
     ShellSort();
@@ -87,21 +90,23 @@ struct MoveSortStruct {
   }
 
   // ȫŷ˳
-  void InitFull(const PositionStruct &pos, int mv, const uint16_t *lpwmvKiller) {
+  void InitFull(const PositionStruct &pos, int mv, const uint16_t *lpwmvKiller, const int *lpnHistoryTab) {
     nPhase = PHASE_HASH;
+    lpnHistory = lpnHistoryTab;
     mvHash = mv;
     mvKiller1 = lpwmvKiller[0];
     mvKiller2 = lpwmvKiller[1];
   }
-  int InitEvade(PositionStruct &pos, int mv, const uint16_t *lpwmvKiller);
+  int InitEvade(PositionStruct &pos, int mv, const uint16_t *lpwmvKiller, const int *lpnHistoryTab);
   int NextFull(const PositionStruct &pos);
 
   // ŷ˳
   void InitRoot(const PositionStruct &pos, int nBanMoves, const uint16_t *lpwmvBanList);
-  void ResetRoot(bool bUnique = false) {
-    nMoveIndex = 0;
+  void ResetRoot(bool bUnique = false, int nPvIndex = 0) {
+    // Ҫģʽ£һҪŷҪŵǰ漸Ҫĺ
+    nMoveIndex = (nPvIndex == 0 ? 0 : nPvIndex - 1);
     ShellSort();
-    nMoveIndex = (bUnique ? 1 : 0);
+    nMoveIndex = (bUnique ? 1 : nPvIndex);
   }
   int NextRoot(void) {
     if (nMoveIndex < nMoveNum) {
@@ -111,12 +116,20 @@ struct MoveSortStruct {
       return 0;
     }
   }
-  void UpdateRoot(int mv);
+  void UpdateRoot(int mv, int nPvIndex = 0);
 };
 
 // ʷ
-inline void ClearHistory(void) {
-  memset(nHistory, 0, sizeof(int[65536]));
+inline void ClearHistory(int *lpnHistory) {
+  memset(lpnHistory, 0, HISTORY_SIZE * sizeof(int));
+}
+
+// ʷ˥ÿʼʱ룬ʹǰϢ𽥵
+inline void AgeHistory(int *lpnHistory) {
+  int i;
+  for (i = 0; i < HISTORY_SIZE; i ++) {
+    lpnHistory[i] /= 2;
+  }
 }
 
 // ɱŷ
@@ -138,8 +151,8 @@ inline void CopyKiller(uint16_t (*lpwmvDst)[2], const uint16_t (*lpwmvSrc)[2]) {
  * 4. ϼϣ磺n^2 + 2^nȵȡ
  * ElephantEyeʹͳƽϵ
  */
-inline void SetBestMove(int mv, int nDepth, uint16_t *lpwmvKiller) {
-  nHistory[mv] += SQR(nDepth);
+inline void SetBestMove(int mv, int nDepth, uint16_t *lpwmvKiller, int *lpnHistory) {
+  lpnHistory[mv] += SQR(nDepth);
   if (lpwmvKiller[0] != mv) {
     lpwmvKiller[1] = lpwmvKiller[0];
     lpwmvKiller[0] = mv;
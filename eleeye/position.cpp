@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include "../base/base.h"
 #include "pregen.h"
 #include "position.h"
+#include "hash.h"
 
 /* ElephantEyeԴʹõǺԼ
  *
@@ -129,18 +130,21 @@ void PositionStruct::AddPiece(int sq, int pc, bool bDel) {
   __ASSERT_BITRANK(this->wBitRanks[RANK_Y(sq)]);
   __ASSERT_BITFILE(this->wBitRanks[FILE_X(sq)]);
   this->dwBitPiece ^= BIT_PIECE(pc);
+#ifdef BITBOARD
+  XorBitBoard(sq, pc);
+#endif
   pt = PIECE_TYPE(pc);
   if (pc < 32) {
     if (bDel) {
-      this->vlWhite -= PreEval.ucvlWhitePieces[pt][sq];
+      this->vlWhite -= lpPreEval->ucvlWhitePieces[pt][sq];
     } else {
-      this->vlWhite += PreEval.ucvlWhitePieces[pt][sq];
+      this->vlWhite += lpPreEval->ucvlWhitePieces[pt][sq];
     }
   } else {
     if (bDel) {
-      this->vlBlack -= PreEval.ucvlBlackPieces[pt][sq];
+      this->vlBlack -= lpPreEval->ucvlBlackPieces[pt][sq];
     } else {
-      this->vlBlack += PreEval.ucvlBlackPieces[pt][sq];
+      this->vlBlack += lpPreEval->ucvlBlackPieces[pt][sq];
     }
     pt += 7;
   }
@@ -177,11 +181,14 @@ int PositionStruct::MovePiece(int mv) {
     //    ͬʱֵλλСZobristֵУ
     this->ucsqPieces[pcCaptured] = 0;
     this->dwBitPiece ^= BIT_PIECE(pcCaptured);
+#ifdef BITBOARD
+    XorBitBoard(sqDst, pcCaptured);
+#endif
     pt = PIECE_TYPE(pcCaptured);
     if (pcCaptured < 32) {
-      this->vlWhite -= PreEval.ucvlWhitePieces[pt][sqDst];
+      this->vlWhite -= lpPreEval->ucvlWhitePieces[pt][sqDst];
     } else {
-      this->vlBlack -= PreEval.ucvlBlackPieces[pt][sqDst];
+      this->vlBlack -= lpPreEval->ucvlBlackPieces[pt][sqDst];
       pt += 7;
     }
     __ASSERT_BOUND(0, pt, 13);
@@ -197,12 +204,15 @@ int PositionStruct::MovePiece(int mv) {
   this->wBitFiles[FILE_X(sqSrc)] ^= PreGen.wBitFileMask[sqSrc];
   __ASSERT_BITRANK(this->wBitRanks[RANK_Y(sqSrc)]);
   __ASSERT_BITFILE(this->wBitRanks[FILE_X(sqSrc)]);
+#ifdef BITBOARD
+  MoveBitBoard(sqSrc, sqDst, pcMoved);
+#endif
   pt = PIECE_TYPE(pcMoved);
   if (pcMoved < 32) {
-    lpucvl = PreEval.ucvlWhitePieces[pt];
+    lpucvl = lpPreEval->ucvlWhitePieces[pt];
     this->vlWhite += lpucvl[sqDst] - lpucvl[sqSrc];
   } else {
-    lpucvl = PreEval.ucvlBlackPieces[pt];
+    lpucvl = lpPreEval->ucvlBlackPieces[pt];
     this->vlBlack += lpucvl[sqDst] - lpucvl[sqSrc];
     pt += 7;
   }
@@ -226,11 +236,17 @@ void PositionStruct::UndoMovePiece(int mv, int pcCaptured) {
   this->wBitFiles[FILE_X(sqSrc)] ^= PreGen.wBitFileMask[sqSrc];
   __ASSERT_BITRANK(this->wBitRanks[RANK_Y(sqSrc)]);
   __ASSERT_BITFILE(this->wBitRanks[FILE_X(sqSrc)]);
+#ifdef BITBOARD
+  MoveBitBoard(sqSrc, sqDst, pcMoved);
+#endif
   if (pcCaptured > 0) {
     __ASSERT_PIECE(pcCaptured);
     this->ucpcSquares[sqDst] = pcCaptured;
     this->ucsqPieces[pcCaptured] = sqDst;
     this->dwBitPiece ^= BIT_PIECE(pcCaptured);
+#ifdef BITBOARD
+    XorBitBoard(sqDst, pcCaptured);
+#endif
   } else {
     this->ucpcSquares[sqDst] = 0;
     this->wBitRanks[RANK_Y(sqDst)] ^= PreGen.wBitRankMask[sqDst];
@@ -258,11 +274,15 @@ int PositionStruct::Promote(int sq) {
   // 2. ȥǰӣͬʱֵZobristֵУ
   this->dwBitPiece ^= BIT_PIECE(pcPromoted) ^ BIT_PIECE(pcCaptured);
   this->ucsqPieces[pcCaptured] = 0;
+#ifdef BITBOARD
+  XorBitBoard(sq, pcCaptured);
+  XorBitBoard(sq, pcPromoted);
+#endif
   pt = PIECE_TYPE(pcCaptured);
   if (pcCaptured < 32) {
-    this->vlWhite -= PreEval.ucvlWhitePieces[pt][sq];
+    this->vlWhite -= lpPreEval->ucvlWhitePieces[pt][sq];
   } else {
-    this->vlBlack -= PreEval.ucvlBlackPieces[pt][sq];
+    this->vlBlack -= lpPreEval->ucvlBlackPieces[pt][sq];
     pt += 7;
   }
   __ASSERT_BOUND(0, pt, 13);
@@ -273,9 +293,9 @@ int PositionStruct::Promote(int sq) {
   this->ucsqPieces[pcPromoted] = sq;
   pt = PIECE_TYPE(pcPromoted);
   if (pcPromoted < 32) {
-    this->vlWhite += PreEval.ucvlWhitePieces[pt][sq];
+    this->vlWhite += lpPreEval->ucvlWhitePieces[pt][sq];
   } else {
-    this->vlBlack += PreEval.ucvlBlackPieces[pt][sq];
+    this->vlBlack += lpPreEval->ucvlBlackPieces[pt][sq];
     pt += 7;
   }
   __ASSERT_BOUND(0, pt, 13);
@@ -294,6 +314,120 @@ void PositionStruct::UndoPromote(int sq, int pcCaptured) {
   this->ucpcSquares[sq] = pcCaptured;
   this->ucsqPieces[pcCaptured] = sq;
   this->dwBitPiece ^= BIT_PIECE(pcPromoted) ^ BIT_PIECE(pcCaptured);
+#ifdef BITBOARD
+  XorBitBoard(sq, pcPromoted);
+  XorBitBoard(sq, pcCaptured);
+#endif
+}
+
+// ƾ
+PositionStruct &PositionStruct::operator =(const PositionStruct &pos) {
+  int i;
+  if (this == &pos) {
+    return *this;
+  }
+  // 1. عбܱԭС
+  ReserveMoves(pos.nMoveMax);
+  // 2. ̲֡ʵݺͻعŷ
+  BoardStruct::operator =(pos);
+  this->lpPreEval = pos.lpPreEval;
+  this->lpPreEvalEx = pos.lpPreEvalEx;
+  this->lpHash = pos.lpHash;
+  this->nMoveNum = pos.nMoveNum;
+  this->nDistance = pos.nDistance;
+  // 3. عбֻõĲ
+  memcpy(this->rbsList, pos.rbsList, pos.nMoveNum * sizeof(RollbackStruct));
+  // 4. ݻعбؽûӺǰ¼ʹÿռŷ
+  for (i = this->nMoveNum - 1; i > 0; i --) {
+    this->wRepHash[this->rbsList[i].zobr.dwKey & this->nRepMask] = i;
+  }
+  return *this;
+}
+
+// Ԥعб
+void PositionStruct::ReserveMoves(int nMoves) {
+  int i, nRepLen;
+  RollbackStruct *lprbs;
+  nMoves = MIN(nMoves, MAX_MOVE_NUM);
+  if (nMoves <= this->nMoveMax) {
+    return;
+  }
+  // 1. µĻعбõĲ
+  lprbs = new RollbackStruct[nMoves];
+  if (this->rbsList != NULL) {
+    memcpy(lprbs, this->rbsList, this->nMoveNum * sizeof(RollbackStruct));
+    delete[] this->rbsList;
+  }
+  this->rbsList = lprbs;
+  this->nMoveMax = nMoves;
+  // 2. µûȡСڻعб42
+  nRepLen = 1;
+  while (nRepLen < nMoves * 4) {
+    nRepLen *= 2;
+  }
+  delete[] this->wRepHash;
+  this->wRepHash = new uint16_t[nRepLen];
+  this->nRepMask = nRepLen - 1;
+  memset(this->wRepHash, 0, nRepLen * sizeof(uint16_t));
+  // 3. ݻعбؽûͬ"operator =()"
+  for (i = this->nMoveNum - 1; i > 0; i --) {
+    this->wRepHash[this->rbsList[i].zobr.dwKey & this->nRepMask] = i;
+  }
+}
+
+// ӹ̶ʽľתʵݲ
+void PositionStruct::FromFixed(const FixedPositionStruct &posf) {
+  int i;
+#ifdef BITBOARD
+  int sq;
+#endif
+  __ASSERT_BOUND(0, posf.nMoveNum, MAX_MOVE_NUM);
+  // 1. ̲
+  this->sdPlayer = posf.sdPlayer;
+  memcpy(this->ucpcSquares, posf.ucpcSquares, 256);
+  memcpy(this->ucsqPieces, posf.ucsqPieces, 48);
+  this->zobr = posf.zobr;
+  this->dwBitPiece = posf.dwBitPiece;
+  memcpy(this->wBitRanks, posf.wBitRanks, 16 * sizeof(uint16_t));
+  memcpy(this->wBitFiles, posf.wBitFiles, 16 * sizeof(uint16_t));
+  this->vlWhite = posf.vlWhite;
+  this->vlBlack = posf.vlBlack;
+#ifdef BITBOARD
+  // 2. ̶ʽľûλ̣
+  memset(this->bbPieces, 0, sizeof(this->bbPieces));
+  memset(this->bbSides, 0, sizeof(this->bbSides));
+  for (sq = 0; sq < 256; sq ++) {
+    if (this->ucpcSquares[sq] != 0) {
+      XorBitBoard(sq, this->ucpcSquares[sq]);
+    }
+  }
+#endif
+  // 3. ƻعбȻؽûͬ"operator =()"
+  this->nMoveNum = 0;
+  ReserveMoves(posf.nMoveNum);
+  memcpy(this->rbsList, posf.rbsList, posf.nMoveNum * sizeof(RollbackStruct));
+  this->nMoveNum = posf.nMoveNum;
+  this->nDistance = posf.nDistance;
+  for (i = this->nMoveNum - 1; i > 0; i --) {
+    this->wRepHash[this->rbsList[i].zobr.dwKey & this->nRepMask] = i;
+  }
+}
+
+// תɹ̶ʽľ
+void PositionStruct::ToFixed(FixedPositionStruct &posf) const {
+  posf.sdPlayer = this->sdPlayer;
+  memcpy(posf.ucpcSquares, this->ucpcSquares, 256);
+  memcpy(posf.ucsqPieces, this->ucsqPieces, 48);
+  posf.zobr = this->zobr;
+  posf.dwBitPiece = this->dwBitPiece;
+  memcpy(posf.wBitRanks, this->wBitRanks, 16 * sizeof(uint16_t));
+  memcpy(posf.wBitFiles, this->wBitFiles, 16 * sizeof(uint16_t));
+  posf.vlWhite = this->vlWhite;
+  posf.vlBlack = this->vlBlack;
+  posf.nMoveNum = this->nMoveNum;
+  posf.nDistance = this->nDistance;
+  memcpy(posf.rbsList, this->rbsList, this->nMoveNum * sizeof(RollbackStruct));
+  memset(posf.ucRepHash, 0, FIXED_REP_HASH_LEN);
 }
 
 // һЩ̴
@@ -301,20 +435,18 @@ void PositionStruct::UndoPromote(int sq, int pcCaptured) {
 // һЩŷ
 
 // ִһŷ
-bool PositionStruct::MakeMove(int mv) {
+bool PositionStruct::MakeMove(int mv, bool bPrefetch) {
   int sq, pcCaptured;
-  uint32_t dwOldZobristKey;
   RollbackStruct *lprbs;
 
-  // ﵽŷôжΪǷŷ
-  if (this->nMoveNum == MAX_MOVE_NUM) {
+  // عб˾䣬ﵽŷôжΪǷŷ
+  if (!MoveRoom()) {
     return false;
   }
-  __ASSERT(this->nMoveNum < MAX_MOVE_NUM);
+  __ASSERT(this->nMoveNum < this->nMoveMax);
   // ִһŷҪ¼裺
 
   // 1. ԭZobristֵ
-  dwOldZobristKey = this->zobr.dwKey;
   SaveStatus();
 
   // 2. ƶӣסԵ(еĻ)
@@ -325,30 +457,40 @@ bool PositionStruct::MakeMove(int mv) {
     pcCaptured = MovePiece(mv);
 
     // 3. ƶ󱻽ˣôŷǷǷģŷ
-    if (CheckedBy(CHECK_LAZY) > 0) {
+    if (MovedIntoCheck(mv)) {
       UndoMovePiece(mv, pcCaptured);
       Rollback();
       return false;
     }
   }
 
-  // 4. ӷ
+  // 4. ӷ¾ZobristֵѾȷ¾ҪȡûôԤȡûͰ
   ChangeSide();
-
-  // 5. ԭZobristֵ¼ظû
-  if (this->ucRepHash[dwOldZobristKey & REP_HASH_MASK] == 0) {
-    this->ucRepHash[dwOldZobristKey & REP_HASH_MASK] = this->nMoveNum;
+  if (bPrefetch) {
+    PrefetchHash(*this);
   }
 
+  // 5. ԭZobristֵ("SaveStatus()"ڻعб)¼ظû
+  SetRepHash(this->nMoveNum);
+
   // 6. ŷ浽ʷŷбУסԵӺͽ״̬
   lprbs = this->rbsList + this->nMoveNum;
   lprbs->mvs.wmv = mv;
-  lprbs->mvs.ChkChs = CheckedBy();
+  // ǰԷûֻиԷ˧()мιϵŷŷſܽ("CHECK_SPAN()")
+  sq = this->ucsqPieces[SIDE_TAG(this->sdPlayer)];
+  if (SRC(mv) == DST(mv) || CHECK_SPAN(SRC(mv), DST(mv), sq) ||
+      (PIECE_TYPE(this->ucpcSquares[DST(mv)]) == KNIGHT_TYPE && KNIGHT_PIN(DST(mv), sq) != DST(mv))) {
+    lprbs->mvs.ChkChs = CheckedBy();
+  } else {
+    __ASSERT(CheckedBy() == 0);
+    lprbs->mvs.ChkChs = 0;
+  }
 
   // 7. úŷ(Ӧ)
   if (pcCaptured == 0) {
+    // ׽״ֻ̬ڳжϺͺŷʱõȼ¡δ㡱Ҫʱ
     if (lprbs->mvs.ChkChs == 0) {
-      lprbs->mvs.ChkChs = -ChasedBy(mv);
+      lprbs->mvs.ChkChs = CHASE_UNKNOWN;
     }
     if (LastMove().CptDrw == -100) {
       lprbs->mvs.CptDrw = -100;
@@ -382,20 +524,37 @@ void PositionStruct::UndoMakeMove(void) {
   }
   this->sdPlayer = OPP_SIDE(this->sdPlayer);
   Rollback();
-  if (this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] == this->nMoveNum) {
-    this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] = 0;
-  }
   __ASSERT(this->nMoveNum > 0);
 }
 
+// ŷǷ񲻻ü"MakeMove()"ĺϷԼһֻƶӣִŷ
+bool PositionStruct::KingSafe(int mv) {
+  int pcCaptured;
+  bool bSafe;
+  if (!MoveRoom()) {
+    return false;
+  }
+  if (SRC(mv) == DST(mv)) {
+    return true; // ŷǺϷ
+  }
+  SaveStatus();
+  pcCaptured = MovePiece(mv);
+  bSafe = !MovedIntoCheck(mv);
+  UndoMovePiece(mv, pcCaptured);
+  Rollback();
+  return bSafe;
+}
+
 // ִһ
-void PositionStruct::NullMove(void) {
+void PositionStruct::NullMove(bool bPrefetch) {
   __ASSERT(this->nMoveNum < MAX_MOVE_NUM);
-  if (this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] == 0) {
-    this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] = this->nMoveNum;
-  }
+  MoveRoom();
   SaveStatus();
+  SetRepHash(this->nMoveNum);
   ChangeSide();
+  if (bPrefetch) {
+    PrefetchHash(*this);
+  }
   this->rbsList[nMoveNum].mvs.dwmv = 0; // wmv, Chk, CptDrw, ChkChs = 0
   this->nMoveNum ++;
   this->nDistance ++;
@@ -407,9 +566,6 @@ void PositionStruct::UndoNullMove(void) {
   this->nDistance --;
   this->sdPlayer = OPP_SIDE(this->sdPlayer);
   Rollback();
-  if (this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] == this->nMoveNum) {
-    this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] = 0;
-  }
   __ASSERT(this->nMoveNum > 0);
 }
 
@@ -535,6 +691,21 @@ void PositionStruct::ToFen(char *szFen) const {
   *lpFen = '\0';
 }
 
+// ZobristֵֻҪλۼӣ"Mirror()"ʷŷ
+void PositionStruct::MirrorZobrist(ZobristStruct &zobrMirror) const {
+  int i, sq;
+  zobrMirror.InitZero();
+  for (i = 16; i < 48; i ++) {
+    sq = this->ucsqPieces[i];
+    if (sq != 0) {
+      zobrMirror.Xor(PreGen.zobrTable[PIECE_TYPE(i) + (i < 32 ? 0 : 7)][SQUARE_MIRROR(sq)]);
+    }
+  }
+  if (this->sdPlayer == 1) {
+    zobrMirror.Xor(PreGen.zobrPlayer);
+  }
+}
+
 // 澵
 void PositionStruct::Mirror(void) {
   int i, sq, nMoveNumSave;
@@ -686,17 +857,63 @@ bool PositionStruct::LegalMove(int mv) const {
   }
 }
 
+#ifdef BITBOARD
+
+// (λ̰汾)ֵİ汾ȫһ
+template <int sd> int PositionStruct::CheckedBySide(bool bLazy) const {
+  int sqSrc, pc, x, y, nOppPieces;
+  BitBoardStruct bbFile, bbCheckers;
+
+  // 1. ж˧()Ƿ
+  sqSrc = this->ucsqPieces[SIDE_TAG(sd)];
+  if (sqSrc == 0) {
+    return 0;
+  }
+  __ASSERT_SQUARE(sqSrc);
+  nOppPieces = (sd == 0 ? 7 : 0);
+
+  // 2. жǷ˧
+  x = FILE_X(sqSrc);
+  y = RANK_Y(sqSrc);
+  bbFile = BB_FILE(x, FileMaskPtr(x, y)->wRookCap);
+  if (!(bbFile & this->bbPieces[nOppPieces + KING_TYPE]).IsZero()) {
+    return CHECK_MULTI;
+  }
+
+  // 3. ܽںͱ()ϲһλУ͵ʱֽͷ
+  bbCheckers = KnightChecks(sqSrc) & this->bbPieces[nOppPieces + KNIGHT_TYPE];
+  bbCheckers |= (bbFile | BB_RANK(y, RankMaskPtr(x, y)->wRookCap)) & this->bbPieces[nOppPieces + ROOK_TYPE];
+  if (bLazy && !bbCheckers.IsZero()) {
+    return CHECK_MULTI;
+  }
+  bbCheckers |= CannonAttacks(sqSrc) & this->bbPieces[nOppPieces + CANNON_TYPE];
+  bbCheckers |= PreGen.bbPawnChecks[sd][sqSrc] & this->bbPieces[nOppPieces + PAWN_TYPE];
+  if (bbCheckers.IsZero()) {
+    return 0;
+  }
+  if (bLazy || bbCheckers.PopCnt() > 1) {
+    return CHECK_MULTI;
+  }
+
+  // 4. ֻһӽ()ʱİ汾һǼһ()
+  pc = this->ucpcSquares[BB_SQUARE(bbCheckers.PopLsb())];
+  __ASSERT_PIECE(pc);
+  return PIECE_INDEX(pc) >= PAWN_FROM ? OPP_SIDE_TAG(sd) + PAWN_FROM : pc;
+}
+
+#else
+
 // 
-int PositionStruct::CheckedBy(bool bLazy) const {
+template <int sd> int PositionStruct::CheckedBySide(bool bLazy) const {
   int pcCheckedBy, i, sqSrc, sqDst, sqPin, pc, x, y, nOppSideTag;
   SlideMaskStruct *lpsmsRank, *lpsmsFile;
 
   pcCheckedBy = 0;
-  nOppSideTag = OPP_SIDE_TAG(this->sdPlayer);
+  nOppSideTag = OPP_SIDE_TAG(sd);
   // жϰ¼ݣ
 
   // 1. ж˧()Ƿ
-  sqSrc = this->ucsqPieces[SIDE_TAG(this->sdPlayer)];
+  sqSrc = this->ucsqPieces[SIDE_TAG(sd)];
   if (sqSrc == 0) {
     return 0;
   }
@@ -796,7 +1013,7 @@ int PositionStruct::CheckedBy(bool bLazy) const {
       __ASSERT_PIECE(pcCheckedBy);
     }
   }
-  pc = this->ucpcSquares[SQUARE_FORWARD(sqSrc, this->sdPlayer)];
+  pc = this->ucpcSquares[SQUARE_FORWARD(sqSrc, sd)];
   if ((pc & nOppSideTag) != 0 && PIECE_INDEX(pc) >= PAWN_FROM) {
     if (bLazy || pcCheckedBy > 0) {
       return CHECK_MULTI;
@@ -807,6 +1024,13 @@ int PositionStruct::CheckedBy(bool bLazy) const {
   return pcCheckedBy;
 }
 
+#endif
+
+// Ժ˫ֱʵÿεֻжһӷ
+int PositionStruct::CheckedBy(bool bLazy) const {
+  return this->sdPlayer == 0 ? CheckedBySide<0>(bLazy) : CheckedBySide<1>(bLazy);
+}
+
 // жǷ񱻽
 bool PositionStruct::IsMate(void) {
   int i, nGenNum;
@@ -829,8 +1053,41 @@ bool PositionStruct::IsMate(void) {
   return true;
 }
 
+// عбδġ׽״̬"nFirst"ָһŷʼ
+void PositionStruct::ResolveChase(int nFirst) {
+  int i, mv, vlWhiteOld, vlBlackOld;
+  ZobristStruct zobrOld;
+  // 㡰׽״̬¼裺
+
+  // 1. Zobristֵֵƶǻı
+  zobrOld = this->zobr;
+  vlWhiteOld = this->vlWhite;
+  vlBlackOld = this->vlBlack;
+
+  // 2. һ˻ŷ˻ǰľǸŷľ棬׽״̬ʱ
+  for (i = this->nMoveNum - 1; i >= nFirst; i --) {
+    mv = this->rbsList[i].mvs.wmv;
+    __ASSERT(SRC(mv) != DST(mv) && this->rbsList[i].mvs.CptDrw <= 0);
+    if (this->rbsList[i].mvs.ChkChs == CHASE_UNKNOWN) {
+      this->rbsList[i].mvs.ChkChs = -ChasedBy(mv);
+    }
+    UndoMovePiece(mv, 0);
+    this->sdPlayer = OPP_SIDE(this->sdPlayer);
+  }
+
+  // 3. ߻Щŷ(ǲӵŷ)ָZobristֵֵ
+  for (i = nFirst; i < this->nMoveNum; i ++) {
+    MovePiece(this->rbsList[i].mvs.wmv);
+    this->sdPlayer = OPP_SIDE(this->sdPlayer);
+  }
+  this->zobr = zobrOld;
+  this->vlWhite = vlWhiteOld;
+  this->vlBlack = vlBlackOld;
+}
+
 // ý״̬λ
 inline void SetPerpCheck(uint32_t &dwPerpCheck, int nChkChs) {
+  __ASSERT(nChkChs != CHASE_UNKNOWN);
   if (nChkChs == 0) {
     dwPerpCheck = 0;
   } else if (nChkChs > 0) {
@@ -843,31 +1100,55 @@ inline void SetPerpCheck(uint32_t &dwPerpCheck, int nChkChs) {
 // ظ
 int PositionStruct::RepStatus(int nRecur) const {
   // "nRecur"ָظȡ1Ч(Ĭֵ)㴦ȡ3Ӧ
-  int sd;
+  int sd, nRecurLeft;
+  bool bChaseUnknown;
   uint32_t dwPerpCheck, dwOppPerpCheck;
   const RollbackStruct *lprbs;
   /* ظ¼裺
    *
    * 1. жϼظûǷеǰ棬ûпܣòж
-   *    û"ucRepHash"ElephantEyeһɫÿִһŷʱͻûм¼µǰ"nMoveNum"
+   *    û"wRepHash"ElephantEyeһɫÿִһŷʱͻûм¼µǰ"nMoveNum"
    *    ûѾ棬Ͳظˣ"MakeMove()"
-   *    ˳ŷʱֻҪûֵǷڵǰ"nMoveNum"ո
-   *    ڵǰ"nMoveNum"˵֮ǰоռûո"position.h"е"UndoMakeMove()"
+   *    ŷ󣬱¼"nMoveNum"˻عбķΧȻʧЧˣԲո"position.h"е"RepHashIndex()"
    */
-  if (this->ucRepHash[this->zobr.dwKey & REP_HASH_MASK] == 0) {
+  if (RepHashIndex(this->zobr.dwKey) == 0) {
     return REP_NONE;
   }
 
-  // 2. ʼ
+  // 2. ȲǳֻѰظ棬ûҲδظûظòż㡰׽
   sd = OPP_SIDE(this->sdPlayer);
-  dwPerpCheck = dwOppPerpCheck = 0x1ffff;
+  nRecurLeft = nRecur;
+  bChaseUnknown = false;
   lprbs = this->rbsList + this->nMoveNum - 1;
-
-  // 3. һŷǿŻŷͲظ
   while (lprbs->mvs.wmv != 0 && lprbs->mvs.CptDrw <= 0) {
     __ASSERT(lprbs >= this->rbsList);
+    bChaseUnknown = bChaseUnknown || lprbs->mvs.ChkChs == CHASE_UNKNOWN;
+    if (sd == this->sdPlayer && lprbs->zobr.dwLock0 == this->zobr.dwLock0 && lprbs->zobr.dwLock1 == this->zobr.dwLock1) {
+      nRecurLeft --;
+      if (nRecurLeft == 0) {
+        break;
+      }
+    }
+    sd = OPP_SIDE(sd);
+    lprbs --;
+  }
+  if (nRecurLeft > 0) {
+    return REP_NONE;
+  }
+
+  // 3. ҵظ棬Ͱظδġ׽״̬
+  //    ظ˻߻ԱΪ"const""posMutable"е"const"Ľɫ
+  if (bChaseUnknown) {
+    PositionStruct &posMutable = (PositionStruct &) *this;
+    posMutable.ResolveChase(lprbs - this->rbsList);
+  }
 
-    // 4. ж˫ĳ򼶱0ʾ޳0xffffʾ׽0x10000ʾ
+  // 4. ¼ŷж˫ĳ򼶱0ʾ޳0xffffʾ׽0x10000ʾ
+  sd = OPP_SIDE(this->sdPlayer);
+  dwPerpCheck = dwOppPerpCheck = 0x1ffff;
+  lprbs = this->rbsList + this->nMoveNum - 1;
+  while (lprbs->mvs.wmv != 0 && lprbs->mvs.CptDrw <= 0) {
+    __ASSERT(lprbs >= this->rbsList);
     if (sd == this->sdPlayer) {
       SetPerpCheck(dwPerpCheck, lprbs->mvs.ChkChs);
 
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <string.h>
 #include "../base/base.h"
 #include "pregen.h"
+#include "preeval.h"
 
 /* ElephantEyeԴʹõǺԼ
  *
@@ -42,9 +43,9 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #define POSITION_H
 
 const int MAX_MOVE_NUM = 1024;  // ɵĻعŷ
+const int MIN_MOVE_NUM = 128;   // عбĳʼʱӱ䣬ֱ"MAX_MOVE_NUM"
 const int MAX_GEN_MOVES = 128;  // ŷйκξ涼ᳬ120ŷ
 const int DRAW_MOVES = 100;     // ĬϵĺŷElephantEye趨50غϼ100Ӧ
-const int REP_HASH_MASK = 4095; // жظûȣ4096
 
 const int MATE_VALUE = 10000;           // ߷ֵķֵ
 const int BAN_VALUE = MATE_VALUE - 100; // иķֵڸֵдû("hash.cpp")
@@ -55,6 +56,7 @@ const int DRAW_VALUE = 20;              // 
 
 const bool CHECK_LAZY = true;   // ͵⽫
 const int CHECK_MULTI = 48;     // ӽ
+const int CHASE_UNKNOWN = -128; // "ChkChs"ֵʾ׽״̬δ("MakeMove()")
 
 // ÿͱ
 const int KING_TYPE = 0;
@@ -224,10 +226,18 @@ struct RollbackStruct {
   MoveStruct mvs;       // ŷ
 }; // rbs
 
+// ۻ("evaluate.cpp"е"Evaluate()")
+struct EvalCacheStruct {
+  uint32_t dwLock0, dwLock1; // У
+  int16_t vl, nLevel;        // ͵ѾĲ͵һΪֹķֵ
+}; // ecs
+
 const bool DEL_PIECE = true; // "PositionStruct::AddPiece()"ѡ
 
-// ṹ
-struct PositionStruct {
+struct HashTableStruct; // û("hash.h")
+
+// ̽ṹвָ롢ֱӸֵĲ("PositionStruct::operator =()")
+struct BoardStruct {
   // Ա
   int sdPlayer;             // ֵķߣ0ʾ췽1ʾڷ
   uint8_t ucpcSquares[256]; // ÿӷŵӣ0ʾû
@@ -241,14 +251,54 @@ struct PositionStruct {
   };
   uint16_t wBitRanks[16];   // λ飬ע÷"wBitRanks[RANK_Y(sq)]"
   uint16_t wBitFiles[16];   // λ飬ע÷"wBitFiles[FILE_X(sq)]"
+#ifdef BITBOARD
+  BitBoardStruct bbPieces[14]; // ÿӵλ̣ͬ"PreGen.zobrTable"06Ǻ췽713Ǻڷ
+  BitBoardStruct bbSides[2];   // ˫ӵλ
+#endif
 
   // 
   int vlWhite, vlBlack;   // 췽ͺڷֵ
+}; // bd
 
-  // عŷѭ
-  int nMoveNum, nDistance;              // عŷ
-  RollbackStruct rbsList[MAX_MOVE_NUM]; // عб
-  uint8_t ucRepHash[REP_HASH_MASK + 1]; // жظû
+/* ̶ʽľ棬ڰ汾"PositionStruct"ȫһ£ָ룬ɵ߷䣬
+ * "CCHESS.DLL""MAKEBOOK.DLL"Visual Basic("cchess/CCHESS.BAS"е"PositionStruct")
+ * ӿں"PositionStruct::FromFixed()"תɾṹ"PositionStruct::ToFixed()"תȥ
+ */
+const int FIXED_REP_HASH_LEN = 4096;
+struct FixedPositionStruct {
+  int sdPlayer;
+  uint8_t ucpcSquares[256];
+  uint8_t ucsqPieces[48];
+  ZobristStruct zobr;
+  uint32_t dwBitPiece;
+  uint16_t wBitRanks[16];
+  uint16_t wBitFiles[16];
+  int vlWhite, vlBlack;
+  int nMoveNum, nDistance;
+  RollbackStruct rbsList[MAX_MOVE_NUM];
+  uint8_t ucRepHash[FIXED_REP_HASH_LEN]; // ڰ汾ûڲã"ToFixed()"ʱ
+}; // posf
+
+// ṹ⣬оʵݺͻعб
+struct PositionStruct : BoardStruct {
+  // ʵݣ渴ʱһ("search.h")̶ʽľûЩ
+  PreEvalStruct *lpPreEval;     // Ԥ۽ṹ
+  PreEvalStructEx *lpPreEvalEx; // չľԤ۽ṹ
+  HashTableStruct *lpHash;      // ûNULLʾʹû
+
+  /* عŷѭ
+   *
+   * ֻ̲мٸֽڣعбظû䣬ƾʱ("operator =()")
+   * عбֻõ"nMoveNum"ûݻعбؽ
+   * عбʹ߰ҪԤ("ReserveMoves()")ʱԤŷļȣ
+   * ʱټӱ䣬ûĳȡСڻعб42ݡ
+   * ûıŷţָֻعбеġZobristֵҲԵϵŷʱЧ("RepHashIndex()")
+   * Գŷ"SetIrrev()"
+   */
+  int nMoveNum, nDistance;  // عŷ
+  int nMoveMax, nRepMask;   // عбû
+  uint16_t *wRepHash;       // жظû
+  RollbackStruct *rbsList;  // عб
 
   // ȡŷԤϢ
   SlideMoveStruct *RankMovePtr(int x, int y) const {
@@ -264,6 +314,68 @@ struct PositionStruct {
     return PreGen.smsFileMaskTab[y - RANK_TOP] + wBitFiles[x];
   }
 
+#ifdef BITBOARD
+  // λ̻ȡŷĿ񣬳ɡλС͡λСԤõ()ֻҪۺ
+  BitBoardStruct Occupied(void) const {
+    return bbSides[0] | bbSides[1];
+  }
+  BitBoardStruct RookAttacks(int sq) const {   // ܳԵĸ(һ)
+    int x = FILE_X(sq), y = RANK_Y(sq);
+    return BB_RANK(y, RankMaskPtr(x, y)->wRookCap) | BB_FILE(x, FileMaskPtr(x, y)->wRookCap);
+  }
+  BitBoardStruct CannonAttacks(int sq) const { // ܳԵĸ(һ)
+    int x = FILE_X(sq), y = RANK_Y(sq);
+    return BB_RANK(y, RankMaskPtr(x, y)->wCannonCap) | BB_FILE(x, FileMaskPtr(x, y)->wCannonCap);
+  }
+  BitBoardStruct SlideNonCaps(int sq) const {  // ڲߵĸ
+    int x = FILE_X(sq), y = RANK_Y(sq);
+    return BB_RANK(y, RankMaskPtr(x, y)->wNonCap) | BB_FILE(x, FileMaskPtr(x, y)->wNonCap);
+  }
+  BitBoardStruct BishopAttacks(int sq) const { // ()ߵĸ(ܸû)
+    int i;
+    BitBoardStruct bbRet;
+    bbRet.InitZero();
+    for (i = 0; i < 4; i ++) {
+      if (ucpcSquares[PreGen.ucsqBishopEyes[sq][i]] == 0) {
+        bbRet |= PreGen.bbBishopMoves[sq][i];
+      }
+    }
+    return bbRet;
+  }
+  BitBoardStruct KnightAttacks(int sq) const { // ߵĸ(ܸû)
+    int i;
+    BitBoardStruct bbRet;
+    bbRet.InitZero();
+    for (i = 0; i < 4; i ++) {
+      if (ucpcSquares[PreGen.ucsqKnightLegs[sq][i]] == 0) {
+        bbRet |= PreGen.bbKnightMoves[sq][i];
+      }
+    }
+    return bbRet;
+  }
+  BitBoardStruct KnightChecks(int sq) const {  // ܲȵøڵĸ
+    int i;
+    BitBoardStruct bbRet;
+    bbRet.InitZero();
+    for (i = 0; i < 4; i ++) {
+      if (ucpcSquares[PreGen.ucsqKnightCheckLegs[sq][i]] == 0) {
+        bbRet |= PreGen.bbKnightChecks[sq][i];
+      }
+    }
+    return bbRet;
+  }
+  void XorBitBoard(int sq, int pc) {           // λӻȥ
+    bbPieces[PIECE_TYPE(pc) + (pc < 32 ? 0 : 7)] ^= PreGen.bbSquareMask[sq];
+    bbSides[pc < 32 ? 0 : 1] ^= PreGen.bbSquareMask[sq];
+  }
+  void MoveBitBoard(int sqSrc, int sqDst, int pc) { // λƶ
+    BitBoardStruct bb;
+    bb = PreGen.bbSquareMask[sqSrc] | PreGen.bbSquareMask[sqDst];
+    bbPieces[PIECE_TYPE(pc) + (pc < 32 ? 0 : 7)] ^= bb;
+    bbSides[pc < 32 ? 0 : 1] ^= bb;
+  }
+#endif
+
   // ̴
   void ClearBoard(void) { // ̳ʼ
     sdPlayer = 0;
@@ -273,7 +385,15 @@ struct PositionStruct {
     dwBitPiece = 0;
     memset(wBitRanks, 0, 16 * sizeof(uint16_t));
     memset(wBitFiles, 0, 16 * sizeof(uint16_t));
+#ifdef BITBOARD
+    memset(bbPieces, 0, sizeof(bbPieces));
+    memset(bbSides, 0, sizeof(bbSides));
+#endif
     vlWhite = vlBlack = 0;
+    lpPreEval = &PreEval;
+    lpPreEvalEx = &PreEvalEx;
+    lpHash = NULL;
+    memset(wRepHash, 0, (nRepMask + 1) * sizeof(uint16_t)); // ҲֻǱδʼڴ
     // "ClearBoard()""SetIrrev()"ʼԱ
   }
   void ChangeSide(void) { // 巽
@@ -294,6 +414,55 @@ struct PositionStruct {
     vlWhite = lprbs->vlWhite;
     vlBlack = lprbs->vlBlack;
   }
+  PositionStruct(void) {                   // 棬ʹĬϵľԤ۽ṹʼĻعб
+    lpPreEval = &PreEval;
+    lpPreEvalEx = &PreEvalEx;
+    lpHash = NULL;
+    nMoveNum = nMoveMax = 0;
+    wRepHash = NULL;
+    rbsList = NULL;
+    ReserveMoves(MIN_MOVE_NUM);
+  }
+  PositionStruct(const PositionStruct &pos) { // ƹ죬ͬ"operator =()"
+    nMoveNum = nMoveMax = 0;
+    wRepHash = NULL;
+    rbsList = NULL;
+    *this = pos;
+  }
+  ~PositionStruct(void) {
+    delete[] wRepHash;
+    delete[] rbsList;
+  }
+  PositionStruct &operator =(const PositionStruct &pos); // ƾ(ֻƻعбõĲ)
+  void ReserveMoves(int nMoves);           // Ԥعб("MAX_MOVE_NUM")
+  void FromFixed(const FixedPositionStruct &posf); // ӹ̶ʽľת
+  void ToFixed(FixedPositionStruct &posf) const;   // תɹ̶ʽľ
+  bool MoveRoom(void) {                    // عбܷټ¼һŷ˾ͼӱ䣬ﵽ"MAX_MOVE_NUM"ʱ"false"
+    if (nMoveNum < nMoveMax) {
+      return true;
+    }
+    if (nMoveMax == MAX_MOVE_NUM) {
+      return false;
+    }
+    ReserveMoves(nMoveMax * 2);
+    return true;
+  }
+  int RepHashIndex(uint32_t dwKey) const { // ûĳZobristֵӦŷţ0ʾû
+    int nIndex;
+    nIndex = wRepHash[dwKey & nRepMask];
+    if (nIndex > 0 && nIndex < nMoveNum && ((rbsList[nIndex].zobr.dwKey ^ dwKey) & nRepMask) == 0) {
+      return nIndex;
+    } else {
+      return 0;
+    }
+  }
+  void SetRepHash(int nIndex) {            // ѻعбеһ¼û(ѱռþͲؼ¼)
+    uint32_t dwKey;
+    dwKey = rbsList[nIndex].zobr.dwKey;
+    if (RepHashIndex(dwKey) == 0) {
+      wRepHash[dwKey & nRepMask] = nIndex;
+    }
+  }
   void AddPiece(int sq, int pc, bool bDel = false); // 
   int MovePiece(int mv);                            // ƶ
   void UndoMovePiece(int mv, int pcCaptured);       // ƶ
@@ -301,22 +470,23 @@ struct PositionStruct {
   void UndoPromote(int sq, int pcCaptured);         // 
 
   // ŷ
-  bool MakeMove(int mv);   // ִһŷ
-  void UndoMakeMove(void); // һŷ
-  void NullMove(void);     // ִһ
-  void UndoNullMove(void); // һ
+  bool MakeMove(int mv, bool bPrefetch = false); // ִһŷ(¾ҪȡûôԤȡ)
+  void UndoMakeMove(void);                       // һŷ
+  void NullMove(bool bPrefetch = false);         // ִһ
+  void UndoNullMove(void);                       // һ
+  bool KingSafe(int mv);                         // ŷǷ񲻻ü(ִŷperftĩ˼)
   void SetIrrev(void) {    // Ѿɡ桱عŷ
     rbsList[0].mvs.dwmv = 0; // wmv, Chk, CptDrw, ChkChs = 0
     rbsList[0].mvs.ChkChs = CheckedBy();
     nMoveNum = 1;
     nDistance = 0;
-    memset(ucRepHash, 0, REP_HASH_MASK + 1);
   }
 
   // 洦
   void FromFen(const char *szFen); // FENʶ
   void ToFen(char *szFen) const;   // FEN
   void Mirror(void);               // 澵
+  void MirrorZobrist(ZobristStruct &zobrMirror) const; // Zobristֵ(汾)
 
   // ŷ
   bool GoodCap(int mv) const {     // õĳŷ⣬ŷ¼ʷɱŷ
@@ -333,6 +503,14 @@ struct PositionStruct {
   }
   bool LegalMove(int mv) const;            // ŷԼ⣬ڡɱŷļ
   int CheckedBy(bool bLazy = false) const; // ĸӽ
+  template <int sd> int CheckedBySide(bool bLazy) const; // ӷʵĽ⣬"CheckedBy()"
+  bool MovedIntoCheck(int mv) const {      // ƶӺӷǷ񱻽(ǰûŷָ˧()ûмιϵͲж)
+    if (LastMove().ChkChs <= 0 && !CHECK_SPAN(SRC(mv), DST(mv), ucsqPieces[SIDE_TAG(sdPlayer)])) {
+      __ASSERT(CheckedBy(CHECK_LAZY) == 0);
+      return false;
+    }
+    return CheckedBy(CHECK_LAZY) > 0;
+  }
   bool IsMate(void);                       // жѱ
   MoveStruct LastMove(void) const {        // ǰһŷŷ˾Ľ״̬
     return rbsList[nMoveNum - 1].mvs;
@@ -347,9 +525,18 @@ struct PositionStruct {
     return (sdPlayer == 0 ? vlWhite : vlBlack) > NULLSAFE_MARGIN;
   }
   bool IsDraw(void) const {                // ж
-    return (!PreEval.bPromotion && (dwBitPiece & BOTH_BITPIECE(ATTACK_BITPIECE)) == 0) ||
+    return (!lpPreEval->bPromotion && (dwBitPiece & BOTH_BITPIECE(ATTACK_BITPIECE)) == 0) ||
         -LastMove().CptDrw >= DRAW_MOVES || nMoveNum == MAX_MOVE_NUM;
   }
+  int LastChkChs(void) {                   // ǰһŷĽ(+)/׽(-)׽״̬ʱż
+    RollbackStruct *lprbs;
+    lprbs = rbsList + nMoveNum - 1;
+    if (lprbs->mvs.ChkChs == CHASE_UNKNOWN) {
+      lprbs->mvs.ChkChs = -ChasedBy(lprbs->mvs.wmv);
+    }
+    return lprbs->mvs.ChkChs;
+  }
+  void ResolveChase(int nFirst);           // عбδġ׽״̬
   int RepStatus(int nRecur = 1) const;     // ظ
   int DrawValue(void) const {              // ķֵ
     return (nDistance & 1) == 0 ? -DRAW_VALUE : DRAW_VALUE;
@@ -360,15 +547,19 @@ struct PositionStruct {
     return vlRep == REP_LOSS ? nDistance - BAN_VALUE : vlRep == REP_WIN ? BAN_VALUE - nDistance : DrawValue();
   }
   int Material(void) const {               // ƽ⣬Ȩ
-    return SIDE_VALUE(sdPlayer, vlWhite - vlBlack) + PreEval.vlAdvanced;
+    return SIDE_VALUE(sdPlayer, vlWhite - vlBlack) + lpPreEval->vlAdvanced;
   }
 
   // ŷɹ̣Щ̴ر԰Ƕ"genmoves.cpp"
   bool Protected(int sd, int sqSrc, int sqExcept = 0) const; // ӱж
   int ChasedBy(int mv) const;                                // ׽ĸ
-  int MvvLva(int sqDst, int pcCaptured, int nLva) const;     // MVV(LVA)ֵ
+  template <int sd> int MvvLva(int sqDst, int pcCaptured, int nLva) const; // MVV(LVA)ֵ
+  int LeastAttacker(int sd, int sqDst) const;                // ĳСֵ
+  int See(int mv) const;                                     // ̬(SEE)
   int GenCapMoves(MoveStruct *lpmvs) const;                  // ŷ
   int GenNonCapMoves(MoveStruct *lpmvs) const;               // ŷ
+  template <int sd> int GenCapMovesSide(MoveStruct *lpmvs) const;    // ӷʵĳŷ
+  template <int sd> int GenNonCapMovesSide(MoveStruct *lpmvs) const; // ӷʵĲŷ
   int GenAllMoves(MoveStruct *lpmvs) const {                 // ȫŷ
     int nCapNum;
     nCapNum = GenCapMoves(lpmvs);
@@ -381,7 +572,7 @@ struct PositionStruct {
   int StringHold(void) const;
   int RookMobility(void) const;
   int KnightTrap(void) const;
-  int Evaluate(int vlAlpha, int vlBeta) const;
+  int Evaluate(int vlAlpha, int vlBeta, EvalCacheStruct &ecs) const;
 }; // pos
 
 #endif
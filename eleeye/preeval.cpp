@@ -20,6 +20,7 @@ License along with this library; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
+#include <string.h>
 #include "../base/base.h"
 #include "pregen.h"
 #include "position.h"
@@ -324,7 +325,7 @@ static const int cvlBottomThreat[16] = {
 
 // ģֻ漰"PositionStruct"е"ucsqPieces""dwBitPiece/wBitPiece""vlWhite""vlBlack"ĸԱʡǰ"this->"
 
-/* Ԥ۾ǳʼԤ(PreEvalPreEvalEx)Ĺ̡
+/* Ԥ۾ǳʼԤ("lpPreEval""lpPreEvalEx"ָĽṹ)Ĺ̡
  * ElephantEyeľԤҪ棺
  * 1. жϾƴڿоֻǲоֽ׶Σ
  * 2. жÿһǷԶԷγв
@@ -339,21 +340,64 @@ const int TOTAL_ATTACK_VALUE = 8;
 const int ADVISOR_BISHOP_ATTACKLESS_VALUE = 80;
 const int TOTAL_ADVISOR_LEAKAGE = 80;
 
-static bool bInit = false;
-
-PreEvalStructEx PreEvalEx;
+/* Ԥõλ÷ֱʱ"PreEvalInit()"ɣԤʱֻҪݾѡ
+ *
+ * Щǰ췽ķ洢ģڷλ÷ɺ췽·תõ
+ * 1. ˧()ڵλ÷ֻ֣о̶ֳйأ
+ * 2. ()λ÷֣о̶ֳȺͱĽ̶йأ
+ * 3. (ʿ)()λ÷֣ǷͶԷĽ̶йء
+ */
+const int PHASE_KING = 0;
+const int PHASE_KNIGHT = 1;
+const int PHASE_ROOK = 2;
+const int PHASE_CANNON = 3;
+
+static struct {
+  uint8_t ucvlPhasePieces[TOTAL_MIDGAME_VALUE + 1][4][256];
+  uint8_t ucvlPawnPieces[TOTAL_MIDGAME_VALUE + 1][TOTAL_ATTACK_VALUE + 1][256];
+  uint8_t ucvlAdvisorBishopPieces[2][TOTAL_ATTACK_VALUE + 1][256];
+} PreEvalTab;
+
+// λ÷ֱÿо̶ֳȺͽ̶ȣԤÿоֺͲо(ͷ)λ÷֮Ĳֵ
+void PreEvalInit(void) {
+  int sq, nMidgameValue, nAttacks;
+  uint8_t ucvlPawnAttackless;
+  for (nMidgameValue = 0; nMidgameValue <= TOTAL_MIDGAME_VALUE; nMidgameValue ++) {
+    for (sq = 0; sq < 256; sq ++) {
+      if (IN_BOARD(sq)) {
+        PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_KING][sq] = (uint8_t)
+            ((cucvlKingPawnMidgameAttacking[sq] * nMidgameValue + cucvlKingPawnEndgameAttacking[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
+        PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_KNIGHT][sq] = (uint8_t)
+            ((cucvlKnightMidgame[sq] * nMidgameValue + cucvlKnightEndgame[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
+        PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_ROOK][sq] = (uint8_t)
+            ((cucvlRookMidgame[sq] * nMidgameValue + cucvlRookEndgame[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
+        PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_CANNON][sq] = (uint8_t)
+            ((cucvlCannonMidgame[sq] * nMidgameValue + cucvlCannonEndgame[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
+        // ()ڽʱλ÷ָ˧()һ
+        ucvlPawnAttackless = (uint8_t)
+            ((cucvlKingPawnMidgameAttackless[sq] * nMidgameValue + cucvlKingPawnEndgameAttackless[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
+        for (nAttacks = 0; nAttacks <= TOTAL_ATTACK_VALUE; nAttacks ++) {
+          PreEvalTab.ucvlPawnPieces[nMidgameValue][nAttacks][sq] = (uint8_t) ((PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_KING][sq] * nAttacks +
+              ucvlPawnAttackless * (TOTAL_ATTACK_VALUE - nAttacks)) / TOTAL_ATTACK_VALUE);
+        }
+      }
+    }
+  }
+  for (nAttacks = 0; nAttacks <= TOTAL_ATTACK_VALUE; nAttacks ++) {
+    for (sq = 0; sq < 256; sq ++) {
+      if (IN_BOARD(sq)) {
+        PreEvalTab.ucvlAdvisorBishopPieces[0][nAttacks][sq] = (uint8_t) ((cucvlAdvisorBishopThreatened[sq] * nAttacks +
+            cucvlAdvisorBishopThreatless[sq] * (TOTAL_ATTACK_VALUE - nAttacks)) / TOTAL_ATTACK_VALUE);
+        PreEvalTab.ucvlAdvisorBishopPieces[1][nAttacks][sq] = (uint8_t) ((cucvlAdvisorBishopThreatened[sq] * nAttacks +
+            cucvlAdvisorBishopPromotionThreatless[sq] * (TOTAL_ATTACK_VALUE - nAttacks)) / TOTAL_ATTACK_VALUE);
+      }
+    }
+  }
+}
 
 void PositionStruct::PreEvaluate(void) {
   int i, sq, nMidgameValue, nWhiteAttacks, nBlackAttacks, nWhiteSimpleValue, nBlackSimpleValue;
-  uint8_t ucvlPawnPiecesAttacking[256], ucvlPawnPiecesAttackless[256];
-
-  if (!bInit) {
-    bInit = true;
-    // ʼ"PreEvalEx.cPopCnt16"飬ֻҪʼһ
-    for (i = 0; i < 65536; i ++) {
-      PreEvalEx.cPopCnt16[i] = PopCnt16(i);
-    }
-  }
+  const uint8_t *lpucvlAdvisorBishop, *lpucvlPawn;
 
   // жϾƴڿоֻǲоֽ׶ΣǼӵճ=6=3=1ӡ
   nMidgameValue = PopCnt32(this->dwBitPiece & BOTH_BITPIECE(ADVISOR_BITPIECE | BISHOP_BITPIECE | PAWN_BITPIECE)) * OTHER_MIDGAME_VALUE;
@@ -362,27 +406,12 @@ void PositionStruct::PreEvaluate(void) {
   // ʹöκʱΪӽо
   nMidgameValue = (2 * TOTAL_MIDGAME_VALUE - nMidgameValue) * nMidgameValue / TOTAL_MIDGAME_VALUE;
   __ASSERT_BOUND(0, nMidgameValue, TOTAL_MIDGAME_VALUE);
-  PreEval.vlAdvanced = (TOTAL_ADVANCED_VALUE * nMidgameValue + TOTAL_ADVANCED_VALUE / 2) / TOTAL_MIDGAME_VALUE;
-  __ASSERT_BOUND(0, PreEval.vlAdvanced, TOTAL_ADVANCED_VALUE);
-  for (sq = 0; sq < 256; sq ++) {
-    if (IN_BOARD(sq)) {
-      PreEval.ucvlWhitePieces[0][sq] = PreEval.ucvlBlackPieces[0][SQUARE_FLIP(sq)] = (uint8_t)
-          ((cucvlKingPawnMidgameAttacking[sq] * nMidgameValue + cucvlKingPawnEndgameAttacking[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
-      PreEval.ucvlWhitePieces[3][sq] = PreEval.ucvlBlackPieces[3][SQUARE_FLIP(sq)] = (uint8_t)
-          ((cucvlKnightMidgame[sq] * nMidgameValue + cucvlKnightEndgame[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
-      PreEval.ucvlWhitePieces[4][sq] = PreEval.ucvlBlackPieces[4][SQUARE_FLIP(sq)] = (uint8_t)
-          ((cucvlRookMidgame[sq] * nMidgameValue + cucvlRookEndgame[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
-      PreEval.ucvlWhitePieces[5][sq] = PreEval.ucvlBlackPieces[5][SQUARE_FLIP(sq)] = (uint8_t)
-          ((cucvlCannonMidgame[sq] * nMidgameValue + cucvlCannonEndgame[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
-      ucvlPawnPiecesAttacking[sq] = PreEval.ucvlWhitePieces[0][sq];
-      ucvlPawnPiecesAttackless[sq] = (uint8_t)
-          ((cucvlKingPawnMidgameAttackless[sq] * nMidgameValue + cucvlKingPawnEndgameAttackless[sq] * (TOTAL_MIDGAME_VALUE - nMidgameValue)) / TOTAL_MIDGAME_VALUE);
-    }
-  }
+  lpPreEval->vlAdvanced = (TOTAL_ADVANCED_VALUE * nMidgameValue + TOTAL_ADVANCED_VALUE / 2) / TOTAL_MIDGAME_VALUE;
+  __ASSERT_BOUND(0, lpPreEval->vlAdvanced, TOTAL_ADVANCED_VALUE);
   for (i = 0; i < 16; i ++) {
-    PreEvalEx.vlHollowThreat[i] = cvlHollowThreat[i] * (nMidgameValue + TOTAL_MIDGAME_VALUE) / (TOTAL_MIDGAME_VALUE * 2);
-    __ASSERT_BOUND(0, PreEvalEx.vlHollowThreat[i], cvlHollowThreat[i]);
-    PreEvalEx.vlCentralThreat[i] = cvlCentralThreat[i];
+    lpPreEvalEx->vlHollowThreat[i] = cvlHollowThreat[i] * (nMidgameValue + TOTAL_MIDGAME_VALUE) / (TOTAL_MIDGAME_VALUE * 2);
+    __ASSERT_BOUND(0, lpPreEvalEx->vlHollowThreat[i], cvlHollowThreat[i]);
+    lpPreEvalEx->vlCentralThreat[i] = cvlCentralThreat[i];
   }
 
   // ȻжϸǷڽ״̬Ǽֹӵճ2ڱ1ӡ
@@ -417,27 +446,37 @@ void PositionStruct::PreEvaluate(void) {
   }
   nWhiteAttacks = MIN(nWhiteAttacks, TOTAL_ATTACK_VALUE);
   nBlackAttacks = MIN(nBlackAttacks, TOTAL_ATTACK_VALUE);
-  PreEvalEx.vlBlackAdvisorLeakage = TOTAL_ADVISOR_LEAKAGE * nWhiteAttacks / TOTAL_ATTACK_VALUE;
-  PreEvalEx.vlWhiteAdvisorLeakage = TOTAL_ADVISOR_LEAKAGE * nBlackAttacks / TOTAL_ATTACK_VALUE;
+  lpPreEvalEx->vlBlackAdvisorLeakage = TOTAL_ADVISOR_LEAKAGE * nWhiteAttacks / TOTAL_ATTACK_VALUE;
+  lpPreEvalEx->vlWhiteAdvisorLeakage = TOTAL_ADVISOR_LEAKAGE * nBlackAttacks / TOTAL_ATTACK_VALUE;
   __ASSERT_BOUND(0, nWhiteAttacks, TOTAL_ATTACK_VALUE);
   __ASSERT_BOUND(0, nBlackAttacks, TOTAL_ATTACK_VALUE);
-  __ASSERT_BOUND(0, PreEvalEx.vlBlackAdvisorLeakage, TOTAL_ADVISOR_LEAKAGE);
-  __ASSERT_BOUND(0, PreEvalEx.vlBlackAdvisorLeakage, TOTAL_ADVISOR_LEAKAGE);
+  __ASSERT_BOUND(0, lpPreEvalEx->vlBlackAdvisorLeakage, TOTAL_ADVISOR_LEAKAGE);
+  __ASSERT_BOUND(0, lpPreEvalEx->vlBlackAdvisorLeakage, TOTAL_ADVISOR_LEAKAGE);
+
+  // ݿо̶ֳȺ˫Ľ̶ѡλ÷ֱ췽ıֱӸƣڷıҪ·ת
+  memcpy(lpPreEval->ucvlWhitePieces[0], PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_KING], 256);
+  memcpy(lpPreEval->ucvlWhitePieces[3], PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_KNIGHT], 256);
+  memcpy(lpPreEval->ucvlWhitePieces[4], PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_ROOK], 256);
+  memcpy(lpPreEval->ucvlWhitePieces[5], PreEvalTab.ucvlPhasePieces[nMidgameValue][PHASE_CANNON], 256);
+  lpucvlAdvisorBishop = PreEvalTab.ucvlAdvisorBishopPieces[lpPreEval->bPromotion ? 1 : 0][nBlackAttacks];
+  memcpy(lpPreEval->ucvlWhitePieces[1], lpucvlAdvisorBishop, 256);
+  memcpy(lpPreEval->ucvlWhitePieces[2], lpucvlAdvisorBishop, 256);
+  memcpy(lpPreEval->ucvlWhitePieces[6], PreEvalTab.ucvlPawnPieces[nMidgameValue][nWhiteAttacks], 256);
+  lpucvlAdvisorBishop = PreEvalTab.ucvlAdvisorBishopPieces[lpPreEval->bPromotion ? 1 : 0][nWhiteAttacks];
+  lpucvlPawn = PreEvalTab.ucvlPawnPieces[nMidgameValue][nBlackAttacks];
   for (sq = 0; sq < 256; sq ++) {
     if (IN_BOARD(sq)) {
-      PreEval.ucvlWhitePieces[1][sq] = PreEval.ucvlWhitePieces[2][sq] = (uint8_t) ((cucvlAdvisorBishopThreatened[sq] * nBlackAttacks +
-          (PreEval.bPromotion ? cucvlAdvisorBishopPromotionThreatless[sq] : cucvlAdvisorBishopThreatless[sq]) * (TOTAL_ATTACK_VALUE - nBlackAttacks)) / TOTAL_ATTACK_VALUE);
-      PreEval.ucvlBlackPieces[1][sq] = PreEval.ucvlBlackPieces[2][sq] = (uint8_t) ((cucvlAdvisorBishopThreatened[SQUARE_FLIP(sq)] * nWhiteAttacks +
-          (PreEval.bPromotion ? cucvlAdvisorBishopPromotionThreatless[SQUARE_FLIP(sq)] : cucvlAdvisorBishopThreatless[SQUARE_FLIP(sq)]) * (TOTAL_ATTACK_VALUE - nWhiteAttacks)) / TOTAL_ATTACK_VALUE);
-      PreEval.ucvlWhitePieces[6][sq] = (uint8_t) ((ucvlPawnPiecesAttacking[sq] * nWhiteAttacks +
-          ucvlPawnPiecesAttackless[sq] * (TOTAL_ATTACK_VALUE - nWhiteAttacks)) / TOTAL_ATTACK_VALUE);
-      PreEval.ucvlBlackPieces[6][sq] = (uint8_t) ((ucvlPawnPiecesAttacking[SQUARE_FLIP(sq)] * nBlackAttacks +
-          ucvlPawnPiecesAttackless[SQUARE_FLIP(sq)] * (TOTAL_ATTACK_VALUE - nBlackAttacks)) / TOTAL_ATTACK_VALUE);
+      lpPreEval->ucvlBlackPieces[0][sq] = lpPreEval->ucvlWhitePieces[0][SQUARE_FLIP(sq)];
+      lpPreEval->ucvlBlackPieces[1][sq] = lpPreEval->ucvlBlackPieces[2][sq] = lpucvlAdvisorBishop[SQUARE_FLIP(sq)];
+      lpPreEval->ucvlBlackPieces[3][sq] = lpPreEval->ucvlWhitePieces[3][SQUARE_FLIP(sq)];
+      lpPreEval->ucvlBlackPieces[4][sq] = lpPreEval->ucvlWhitePieces[4][SQUARE_FLIP(sq)];
+      lpPreEval->ucvlBlackPieces[5][sq] = lpPreEval->ucvlWhitePieces[5][SQUARE_FLIP(sq)];
+      lpPreEval->ucvlBlackPieces[6][sq] = lpucvlPawn[SQUARE_FLIP(sq)];
     }
   }
   for (i = 0; i < 16; i ++) {
-    PreEvalEx.vlWhiteBottomThreat[i] = cvlBottomThreat[i] * nBlackAttacks / TOTAL_ATTACK_VALUE;
-    PreEvalEx.vlBlackBottomThreat[i] = cvlBottomThreat[i] * nWhiteAttacks / TOTAL_ATTACK_VALUE;
+    lpPreEvalEx->vlWhiteBottomThreat[i] = cvlBottomThreat[i] * nBlackAttacks / TOTAL_ATTACK_VALUE;
+    lpPreEvalEx->vlBlackBottomThreat[i] = cvlBottomThreat[i] * nWhiteAttacks / TOTAL_ATTACK_VALUE;
   }
 
   // ԤǷԳ
@@ -445,14 +484,14 @@ void PositionStruct::PreEvaluate(void) {
   for (sq = 0; sq < 256; sq ++) {
     if (IN_BOARD(sq)) {
       for (i = 0; i < 7; i ++) {
-        __ASSERT(PreEval.ucvlWhitePieces[i][sq] == PreEval.ucvlWhitePieces[i][SQUARE_MIRROR(sq)]);
-        __ASSERT(PreEval.ucvlBlackPieces[i][sq] == PreEval.ucvlBlackPieces[i][SQUARE_MIRROR(sq)]);
+        __ASSERT(lpPreEval->ucvlWhitePieces[i][sq] == lpPreEval->ucvlWhitePieces[i][SQUARE_MIRROR(sq)]);
+        __ASSERT(lpPreEval->ucvlBlackPieces[i][sq] == lpPreEval->ucvlBlackPieces[i][SQUARE_MIRROR(sq)]);
       }
     }
   }
   for (i = FILE_LEFT; i <= FILE_RIGHT; i ++) {
-    __ASSERT(PreEvalEx.vlWhiteBottomThreat[i] == PreEvalEx.vlWhiteBottomThreat[FILE_FLIP(i)]);
-    __ASSERT(PreEvalEx.vlBlackBottomThreat[i] == PreEvalEx.vlBlackBottomThreat[FILE_FLIP(i)]);
+    __ASSERT(lpPreEvalEx->vlWhiteBottomThreat[i] == lpPreEvalEx->vlWhiteBottomThreat[FILE_FLIP(i)]);
+    __ASSERT(lpPreEvalEx->vlBlackBottomThreat[i] == lpPreEvalEx->vlBlackBottomThreat[FILE_FLIP(i)]);
   }
 #endif
 
@@ -460,7 +499,7 @@ void PositionStruct::PreEvaluate(void) {
   this->vlWhite = ADVISOR_BISHOP_ATTACKLESS_VALUE * (TOTAL_ATTACK_VALUE - nBlackAttacks) / TOTAL_ATTACK_VALUE;
   this->vlBlack = ADVISOR_BISHOP_ATTACKLESS_VALUE * (TOTAL_ATTACK_VALUE - nWhiteAttacks) / TOTAL_ATTACK_VALUE;
   // 䣬ôв(ʿ)()ֵһ
-  if (PreEval.bPromotion) {
+  if (lpPreEval->bPromotion) {
     this->vlWhite /= 2;
     this->vlBlack /= 2;
   }
@@ -469,14 +508,14 @@ void PositionStruct::PreEvaluate(void) {
     sq = this->ucsqPieces[i];
     if (sq != 0) {
       __ASSERT_SQUARE(sq);
-      this->vlWhite += PreEval.ucvlWhitePieces[PIECE_TYPE(i)][sq];
+      this->vlWhite += lpPreEval->ucvlWhitePieces[PIECE_TYPE(i)][sq];
     }
   }
   for (i = 32; i < 48; i ++) {
     sq = this->ucsqPieces[i];
     if (sq != 0) {
       __ASSERT_SQUARE(sq);
-      this->vlBlack += PreEval.ucvlBlackPieces[PIECE_TYPE(i)][sq];
+      this->vlBlack += lpPreEval->ucvlBlackPieces[PIECE_TYPE(i)][sq];
     }
   }
 }
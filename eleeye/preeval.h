@@ -23,12 +23,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #ifndef PREEVAL_H
 #define PREEVAL_H
 
-// չľԤ۽ṹ
+// չľԤ۽ṹȱʡȫֽṹ"pregen.cpp"
 extern struct PreEvalStructEx {
   int vlBlackAdvisorLeakage, vlWhiteAdvisorLeakage;
   int vlHollowThreat[16], vlCentralThreat[16];
   int vlWhiteBottomThreat[16], vlBlackBottomThreat[16];
-  char cPopCnt16[65536]; // PopCnt16飬ֻҪʼһ
 } PreEvalEx;
 
+void PreEvalInit(void); // λ÷ֱ"PreGenInit()"֮һ
+
 #endif
@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <string.h>
 #include "../base/base.h"
 #include "pregen.h"
+#include "preeval.h"
 
 const bool cbcInBoard[256] = {
   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -155,6 +156,7 @@ const int8_t ccKnightPinTab[512] = {
 
 PreGenStruct PreGen;
 PreEvalStruct PreEval;
+PreEvalStructEx PreEvalEx;
 
 // ĸжӵӷΪǣsqDst = sqSrc + cnKnightMoveTab[i]
 static const int cnKingMoveTab[4]    = {-0x10, -0x01, +0x01, +0x10};
@@ -405,7 +407,97 @@ void PreGenInit(void) {
     }
   }
 
+#ifdef BITBOARD
+  // λ̵Ԥ
+  memset(PreGen.bbSquareMask, 0, sizeof(PreGen.bbSquareMask));
+  for (sqSrc = 0; sqSrc < 256; sqSrc ++) {
+    if (IN_BOARD(sqSrc)) {
+      i = BB_INDEX(sqSrc);
+      PreGen.ucsqBitSquares[i] = sqSrc;
+      if (i < BB_LOW_BITS) {
+        PreGen.bbSquareMask[sqSrc].qwLow = (uint64_t) 1 << i;
+      } else {
+        PreGen.bbSquareMask[sqSrc].qwHigh = (uint64_t) 1 << (i - BB_LOW_BITS);
+      }
+    }
+  }
+  for (i = 0; i < 1024; i ++) {
+    PreGen.bbFileSpread[i].InitZero();
+    for (j = 0; j < 10; j ++) {
+      if ((i & (1 << j)) != 0) {
+        PreGen.bbFileSpread[i] |= PreGen.bbSquareMask[COORD_XY(FILE_LEFT, j + RANK_TOP)];
+      }
+    }
+  }
+  for (sqSrc = 0; sqSrc < 256; sqSrc ++) {
+    PreGen.bbKingMoves[sqSrc].InitZero();
+    PreGen.bbAdvisorMoves[sqSrc].InitZero();
+    PreGen.bbPawnMoves[0][sqSrc].InitZero();
+    PreGen.bbPawnMoves[1][sqSrc].InitZero();
+    PreGen.bbPawnChecks[0][sqSrc].InitZero();
+    PreGen.bbPawnChecks[1][sqSrc].InitZero();
+    for (i = 0; i < 4; i ++) {
+      PreGen.bbBishopMoves[sqSrc][i].InitZero();
+      PreGen.ucsqBishopEyes[sqSrc][i] = 0;
+      PreGen.bbKnightMoves[sqSrc][i].InitZero();
+      PreGen.ucsqKnightLegs[sqSrc][i] = 0;
+      PreGen.bbKnightChecks[sqSrc][i].InitZero();
+      PreGen.ucsqKnightCheckLegs[sqSrc][i] = 0;
+    }
+    if (!IN_BOARD(sqSrc)) {
+      continue;
+    }
+    // ˧()(ʿ)ͱ()ŷֱŷԤõ
+    for (i = 0; PreGen.ucsqKingMoves[sqSrc][i] != 0; i ++) {
+      PreGen.bbKingMoves[sqSrc] |= PreGen.bbSquareMask[PreGen.ucsqKingMoves[sqSrc][i]];
+    }
+    for (i = 0; PreGen.ucsqAdvisorMoves[sqSrc][i] != 0; i ++) {
+      PreGen.bbAdvisorMoves[sqSrc] |= PreGen.bbSquareMask[PreGen.ucsqAdvisorMoves[sqSrc][i]];
+    }
+    for (i = 0; i < 2; i ++) {
+      for (j = 0; PreGen.ucsqPawnMoves[i][sqSrc][j] != 0; j ++) {
+        PreGen.bbPawnMoves[i][sqSrc] |= PreGen.bbSquareMask[PreGen.ucsqPawnMoves[i][sqSrc][j]];
+      }
+      // "CheckedBy()"һ˧()ǰĶԷ()㽫
+      PreGen.bbPawnChecks[i][sqSrc] = PreGen.bbSquareMask[sqSrc - 1] | PreGen.bbSquareMask[sqSrc + 1] |
+          PreGen.bbSquareMask[SQUARE_FORWARD(sqSrc, i)];
+    }
+    // ()ŷ۷
+    for (i = 0; i < 4; i ++) {
+      sqDst = sqSrc + cnBishopMoveTab[i];
+      if (IN_BOARD(sqDst) && SAME_HALF(sqSrc, sqDst)) {
+        PreGen.bbBishopMoves[sqSrc][i] = PreGen.bbSquareMask[sqDst];
+        PreGen.ucsqBishopEyes[sqSrc][i] = BISHOP_PIN(sqSrc, sqDst);
+      }
+    }
+    // ŷȷ飬ȵ˳ͬ"cnKingMoveTab"ȵĳȷ飬ȵ˳ͬ"cnAdvisorMoveTab"
+    for (i = 0; i < 4; i ++) {
+      PreGen.ucsqKnightLegs[sqSrc][i] = sqSrc + cnKingMoveTab[i];
+      PreGen.ucsqKnightCheckLegs[sqSrc][i] = sqSrc + cnAdvisorMoveTab[i];
+    }
+    for (i = 0; i < 8; i ++) {
+      sqDst = sqSrc + cnKnightMoveTab[i];
+      if (IN_BOARD(sqDst)) {
+        for (j = 0; j < 4; j ++) {
+          if (KNIGHT_PIN(sqSrc, sqDst) == sqSrc + cnKingMoveTab[j]) {
+            PreGen.bbKnightMoves[sqSrc][j] |= PreGen.bbSquareMask[sqDst];
+          }
+          if (KNIGHT_PIN(sqDst, sqSrc) == sqSrc + cnAdvisorMoveTab[j]) {
+            PreGen.bbKnightChecks[sqSrc][j] |= PreGen.bbSquareMask[sqDst];
+          }
+        }
+      }
+    }
+  }
+#endif
+
+  // ʼ"cPopCnt16"
+  for (i = 0; i < 65536; i ++) {
+    PreGen.cPopCnt16[i] = PopCnt16(i);
+  }
+
   // վԤ۽ṹ
   memset(&PreEval, 0, sizeof(PreEvalStruct));
+  memset(&PreEvalEx, 0, sizeof(PreEvalStructEx));
   PreEval.bPromotion = false; // ȱʡǲ
 }
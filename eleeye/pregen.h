@@ -143,6 +143,21 @@ inline bool DIFF_HALF(int sqSrc, int sqDst) {
   return ((sqSrc ^ sqDst) & 0x80) != 0;
 }
 
+inline bool SAME_RANK(int sqSrc, int sqDst) {
+  return ((sqSrc ^ sqDst) & 0xf0) == 0;
+}
+
+inline bool SAME_FILE(int sqSrc, int sqDst) {
+  return ((sqSrc ^ sqDst) & 0x0f) == 0;
+}
+
+// ŷֻյ˧()ͬлͬ(ڵĹߺڼ)˧()б()ʱ
+// ſ˧()ܵµĹ(˧()ûƶҲû())״̬ı
+inline bool CHECK_SPAN(int sqSrc, int sqDst, int sqKing) {
+  return SAME_RANK(sqSrc, sqKing) || SAME_FILE(sqSrc, sqKing) || SAME_RANK(sqDst, sqKing) ||
+      SAME_FILE(sqDst, sqKing) || ADVISOR_SPAN(sqSrc, sqKing);
+}
+
 inline int RANK_DISP(int y) {
   return y << 4;
 }
@@ -186,6 +201,75 @@ struct ZobristStruct {
   }
 }; // zobr
 
+#ifdef BITBOARD
+
+/* λ"-DBITBOARD"ʱõһ̱ʾ16x16鲢棺
+ *
+ * ϵ90ζӦ128λĵ089λϵµy(09)ҵx(08)ĸӶӦ"9 * y + x"λ
+ * ÿ9λǰ7(63λ)ڵ64λУ3зڸ64λУκһжԽ64λ
+ * ĳһеλ̾ǡλСλĳһеλ̾ǵ0еλλڵĹֱɡλС͡λСԤõ
+ */
+const int BB_LOW_RANKS = 7;  // ڵ64λе
+const int BB_LOW_BITS = 63;  // 64λõλ
+
+struct BitBoardStruct {
+  uint64_t qwLow, qwHigh;
+  void InitZero(void) {
+    qwLow = qwHigh = 0;
+  }
+  bool IsZero(void) const {
+    return (qwLow | qwHigh) == 0;
+  }
+  BitBoardStruct operator &(const BitBoardStruct &bb) const {
+    BitBoardStruct bbRet;
+    bbRet.qwLow = qwLow & bb.qwLow;
+    bbRet.qwHigh = qwHigh & bb.qwHigh;
+    return bbRet;
+  }
+  BitBoardStruct operator |(const BitBoardStruct &bb) const {
+    BitBoardStruct bbRet;
+    bbRet.qwLow = qwLow | bb.qwLow;
+    bbRet.qwHigh = qwHigh | bb.qwHigh;
+    return bbRet;
+  }
+  BitBoardStruct AndNot(const BitBoardStruct &bb) const {
+    BitBoardStruct bbRet;
+    bbRet.qwLow = qwLow & ~bb.qwLow;
+    bbRet.qwHigh = qwHigh & ~bb.qwHigh;
+    return bbRet;
+  }
+  void operator |=(const BitBoardStruct &bb) {
+    qwLow |= bb.qwLow;
+    qwHigh |= bb.qwHigh;
+  }
+  void operator ^=(const BitBoardStruct &bb) {
+    qwLow ^= bb.qwLow;
+    qwHigh ^= bb.qwHigh;
+  }
+  void Shift(int nBits) { // ƣֻڰѵ0еλƵУԲпԽ64λ
+    qwLow <<= nBits;
+    qwHigh <<= nBits;
+  }
+  int PopCnt(void) const {
+    return PopCnt32(LOW_LONG(qwLow)) + PopCnt32(HIGH_LONG(qwLow)) +
+        PopCnt32(LOW_LONG(qwHigh)) + PopCnt32(HIGH_LONG(qwHigh));
+  }
+  int PopLsb(void) { // ȡ͵һλظλ
+    int nBit;
+    if (qwLow != 0) {
+      nBit = (LOW_LONG(qwLow) != 0 ? Bsf(LOW_LONG(qwLow)) : Bsf(HIGH_LONG(qwLow)) + 32);
+      qwLow &= qwLow - 1;
+    } else {
+      __ASSERT(qwHigh != 0);
+      nBit = (LOW_LONG(qwHigh) != 0 ? Bsf(LOW_LONG(qwHigh)) : Bsf(HIGH_LONG(qwHigh)) + 32) + BB_LOW_BITS;
+      qwHigh &= qwHigh - 1;
+    }
+    return nBit;
+  }
+}; // bb
+
+#endif
+
 extern struct PreGenStruct {
   // ZobristֵZobristֵZobristУ
   ZobristStruct zobrPlayer;
@@ -224,9 +308,64 @@ extern struct PreGenStruct {
   uint8_t ucsqKnightMoves[256][12];
   uint8_t ucsqKnightPins[256][8];
   uint8_t ucsqPawnMoves[2][256][4];
+
+  char cPopCnt16[65536]; // PopCnt16
+
+#ifdef BITBOARD
+  /* λ̵Ԥ
+   *
+   * ()ŷۺȷ飬ÿһλ̣ۻûסʱһĸӾͶߵ
+   * "bbKnightChecks"ǷģĳܱЩȵ(ӵб)飬ڽжϡ
+   */
+  uint8_t ucsqBitSquares[90];          // ÿһλӦĸ
+  BitBoardStruct bbSquareMask[256];    // ÿӵλĸ0
+  BitBoardStruct bbFileSpread[1024];   // 0еλչɵλ
+  BitBoardStruct bbKingMoves[256];
+  BitBoardStruct bbAdvisorMoves[256];
+  BitBoardStruct bbBishopMoves[256][4];
+  uint8_t ucsqBishopEyes[256][4];
+  BitBoardStruct bbKnightMoves[256][4];
+  uint8_t ucsqKnightLegs[256][4];
+  BitBoardStruct bbKnightChecks[256][4];
+  uint8_t ucsqKnightCheckLegs[256][4];
+  BitBoardStruct bbPawnMoves[2][256];
+  BitBoardStruct bbPawnChecks[2][256]; // ܽĳӵ˧()ı()ڵĸ
+#endif
 } PreGen;
 
-// Ԥ۽ṹ
+#ifdef BITBOARD
+
+inline int BB_INDEX(int sq) {
+  return (RANK_Y(sq) - RANK_TOP) * 9 + FILE_X(sq) - FILE_LEFT;
+}
+
+inline int BB_SQUARE(int nBit) {
+  return PreGen.ucsqBitSquares[nBit];
+}
+
+inline BitBoardStruct BB_RANK(int y, int wBitRank) { // ѵyеġλСչλ
+  BitBoardStruct bbRet;
+  y -= RANK_TOP;
+  if (y < BB_LOW_RANKS) {
+    bbRet.qwLow = (uint64_t) wBitRank << (y * 9);
+    bbRet.qwHigh = 0;
+  } else {
+    bbRet.qwLow = 0;
+    bbRet.qwHigh = (uint64_t) wBitRank << ((y - BB_LOW_RANKS) * 9);
+  }
+  return bbRet;
+}
+
+inline BitBoardStruct BB_FILE(int x, int wBitFile) { // ѵxеġλСչλ
+  BitBoardStruct bbRet;
+  bbRet = PreGen.bbFileSpread[wBitFile];
+  bbRet.Shift(x - FILE_LEFT);
+  return bbRet;
+}
+
+#endif
+
+// Ԥ۽ṹÿʵиԵľԤ۽ṹ("search.h")ȫֽṹȱʡ
 extern struct PreEvalStruct {
   bool bPromotion;
   int vlAdvanced;
@@ -37,31 +37,125 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 const int IID_DEPTH = 2;         // ڲ
 const int SMP_DEPTH = 6;         // 
 const int UNCHANGED_DEPTH = 4;   // δıŷ
+const int ASPIRATION_DEPTH = 4;  // ʹÿڵ
+const int REDUCTION_DEPTH = 3;   // ʹúŷȵС
+const int REDUCTION_MOVES = 4;   // ȵŷ
 
+const int EVAL_CACHE_MASK = 16383; // ۻĳȣ16384
+
+const int ASPIRATION_WINDOW = 16; // ڵĳʼ()ÿεͳ߽߳ʱӱ
 const int DROPDOWN_VALUE = 20;   // ķֵ
 const int RESIGN_VALUE = 300;    // ķֵ
 const int DRAW_OFFER_VALUE = 40; // ͵ķֵ
 
-SearchStruct Search;
-
-// ϢǷװģڲ
-static struct {
+// ϢǷװģڲģÿʵиԵϢ
+struct SearchInfoStruct {
   int64_t llTime;                     // ʱ
-  bool bStop, bPonderStop;            // ֹźźͺ̨˼Ϊֹź
+  volatile bool bStop;                // ֹźţ̹߳
+  bool bPonderStop;                   // ̨˼Ϊֹź
   bool bPopPv, bPopCurrMove;          // Ƿpvcurrmove
   int nPopDepth, vlPopValue;          // Ⱥͷֵ
-  int nAllNodes, nMainNodes;          // ܽĽ
   int nUnchanged;                     // δıŷ
   uint16_t wmvPvLine[MAX_MOVE_NUM];   // Ҫ·ϵŷб
+  int nMultiPv;                       // Ҫģʽ£εѾҪ
+  int vlMultiPv[MAX_MULTI_PV];        // Ҫķֵ
+  uint16_t wmvMultiPv[MAX_MULTI_PV - 1][MAX_MOVE_NUM]; // 2ĶҪ(1"wmvPvLine")
+}; // Search2
+
+/* ߳Ϣÿ߳иԵľ桢ɱŷʷۻ͸ŷУֻ֮߳û
+ *
+ * ElephantEyeĶ߳Lazy SMP̸߳߳һ
+ * ໥֮䲻κͨţֻͨû߳̾ʱֹŷ
+ */
+struct SearchThreadStruct {
+  EngineStruct *lpeng;                // ߳ʵ
+  PositionStruct pos;                 // ߳ľ
+  int nThread, nDepth;                // ߳(0ʾ߳)޶
+  volatile bool bBusy, bExit;         // ߳ǷǷҪ˳
+  ThreadHandleStruct Thread;          // ̣߳ͷʵʱȴ
+  EventStruct evStart;                // еĸ̵߳ȴ¼Ҫ˳ʱ
+  int64_t llAllNodes, llMainNodes;    // ܽĽ
+  int nSelDepth;                      // (ѡ)
   uint16_t wmvKiller[LIMIT_DEPTH][2]; // ɱŷ
+  int nHistory[HISTORY_SIZE];         // ʷ
+  EvalCacheStruct ecsTable[EVAL_CACHE_MASK + 1]; // ۻ
+  int64_t llEvalProbes, llEvalHits;   // ۻĲҴд
   MoveSortStruct MoveSort;            // ŷ
-} Search2;
+}; // thd
+
+// ̵߳ܽ
+static int64_t AllNodes(const EngineStruct &eng) {
+  int i;
+  int64_t llAllNodes;
+  llAllNodes = 0;
+  for (i = 0; i < eng.nThreads; i ++) {
+    llAllNodes += eng.lpThreads[i]->llAllNodes;
+  }
+  return llAllNodes;
+}
+
+// ̵߳ѡ
+static int SelDepth(const EngineStruct &eng) {
+  int i, nSelDepth;
+  nSelDepth = 0;
+  for (i = 0; i < eng.nThreads; i ++) {
+    nSelDepth = MAX(nSelDepth, eng.lpThreads[i]->nSelDepth);
+  }
+  return nSelDepth;
+}
+
+// ߳Ϣɱŷʷ
+static SearchThreadStruct *NewThread(EngineStruct &eng, int nThread) {
+  SearchThreadStruct *lpthd;
+  lpthd = new SearchThreadStruct;
+  lpthd->lpeng = &eng;
+  lpthd->nThread = nThread;
+  lpthd->bBusy = lpthd->bExit = false;
+  ClearKiller(lpthd->wmvKiller);
+  ClearHistory(lpthd->nHistory);
+  return lpthd;
+}
 
+bool NewEngine(EngineStruct &eng, int nHashScale) {
+  SearchStruct &Search = eng.Search;
+  eng.Hash.hshItems = NULL;
+  if (!NewHash(eng.Hash, nHashScale)) {
+    return false;
+  }
+  memset(&eng.PreEval, 0, sizeof(PreEvalStruct));
+  eng.PreEval.bPromotion = false; // ȱʡǲ
+  memset(&eng.PreEvalEx, 0, sizeof(PreEvalStructEx));
+  eng.lpSearch2 = new SearchInfoStruct;
+  eng.lpThreads[0] = NewThread(eng, 0);
+  eng.nThreads = eng.nThreadsStarted = 1;
+  Search.pos.FromFen(cszStartFen);
+  BindPos(eng, Search.pos);
+  Search.pos.nDistance = 0;
+  Search.pos.PreEvaluate();
+  Search.nBanMoves = 0;
+  Search.bQuit = Search.bBatch = Search.bDebug = Search.bQuiet = false;
+  Search.bUseHash = Search.bUseBook = Search.bNullMove = Search.bKnowledge = true;
+  Search.bIdle = false;
+  Search.nCountMask = INTERRUPT_COUNT - 1;
+  Search.nRandomMask = 0;
+  Search.nMultiPv = 1;
+  Search.rc4Random.InitRand();
+  Search.szBookFile[0] = '\0';
 #ifndef CCHESS_A3800
+  eng.Books.nBooks = 0;
+#endif
+  Search.mvResult = 0;
+  return true;
+}
 
-void BuildPos(PositionStruct &pos, const UcciCommStruct &UcciComm) {
+#ifndef CCHESS_A3800
+
+void BuildPos(EngineStruct &eng, PositionStruct &pos, const UcciCommStruct &UcciComm) {
   int i, mv;
   pos.FromFen(UcciComm.szFenStr);
+  BindPos(eng, pos);
+  // عбҪŷټļ
+  pos.ReserveMoves(UcciComm.nMoveNum + LIMIT_DEPTH + 1);
   for (i = 0; i < UcciComm.nMoveNum; i ++) {
     mv = COORD_MOVE(UcciComm.lpdwMovesCoord[i]);
     if (mv == 0) {
@@ -76,13 +170,19 @@ void BuildPos(PositionStruct &pos, const UcciCommStruct &UcciComm) {
 
 #endif
 
-// ж
-static bool Interrupt(void) {
+// жֹֻ̣߳ź
+static bool Interrupt(const SearchThreadStruct &thd) {
+  EngineStruct &eng = *thd.lpeng;
+  SearchStruct &Search = eng.Search;
+  SearchInfoStruct &Search2 = *eng.lpSearch2;
+  if (thd.nThread > 0) {
+    return Search2.bStop;
+  }
   if (Search.bIdle) {
     Idle();
   }
   if (Search.nGoMode == GO_MODE_NODES) {
-    if (!Search.bPonder && Search2.nAllNodes > Search.nNodes * 4) {
+    if (!Search.bPonder && AllNodes(eng) > Search.llNodes * 4) {
       Search2.bStop = true;
       return true;
     }
@@ -101,7 +201,24 @@ static bool Interrupt(void) {
 #else
   UcciCommStruct UcciComm;
   PositionStruct posProbe;
-  // ģʽôȵUCCIͳжǷֹ
+  // ģʽôȼ߳õźţ"stop"ָѾֱֹ߳ź
+  if (UcciBusy.bPonderHit) {
+    // "ponderhit"ָʱܣ"SearchMain()"ΪѾ㹻ʱ䣬 ôֹźţ
+    // "ponderhit draw"ָҪͱ־
+    MemFence();
+    Search.bDraw = (Search.bDraw || UcciBusy.bDraw);
+    UcciBusy.bPonderHit = UcciBusy.bDraw = false;
+    if (Search2.bPonderStop) {
+      Search2.bStop = true;
+      return true;
+    } else {
+      Search.bPonder = false;
+    }
+  }
+  // ָʱŵUCCIͳ
+  if (!InputReady()) {
+    return false;
+  }
   switch (BusyLine(UcciComm, Search.bDebug)) {
   case UCCI_COMM_ISREADY:
     // "isready"ָʵû
@@ -133,7 +250,7 @@ static bool Interrupt(void) {
     return true;
   case UCCI_COMM_PROBE:
     // "probe"ָHashϢ
-    BuildPos(posProbe, UcciComm);
+    BuildPos(eng, posProbe, UcciComm);
     PopHash(posProbe);
     return false;
   case UCCI_COMM_QUIT:
@@ -148,22 +265,52 @@ static bool Interrupt(void) {
 
 #ifndef CCHESS_A3800
 
+// ʱ䡢ÿûʹ()
+static void PopStats(const EngineStruct &eng) {
+  int nTime;
+  int64_t llNodes;
+  nTime = (int) (GetTime() - eng.lpSearch2->llTime);
+  llNodes = AllNodes(eng);
+  printf(" time %d nodes %" FORMAT_I64 "d nps %" FORMAT_I64 "d hashfull %d",
+      nTime, llNodes, llNodes * 1000 / MAX(nTime, 1), HashFull(eng.Hash));
+}
+
+// ۻĲҴд(ǧֱ)ֻڵģʽ
+static void PopEvalCache(const EngineStruct &eng) {
+  int i;
+  int64_t llProbes, llHits;
+  llProbes = llHits = 0;
+  for (i = 0; i < eng.nThreads; i ++) {
+    llProbes += eng.lpThreads[i]->llEvalProbes;
+    llHits += eng.lpThreads[i]->llEvalHits;
+  }
+  printf("info evalcache probes %" FORMAT_I64 "d hits %" FORMAT_I64 "d hitrate %d\n",
+      llProbes, llHits, (int) (llHits * 1000 / MAX(llProbes, (int64_t) 1)));
+  fflush(stdout);
+}
+
 // Ҫ
-static void PopPvLine(int nDepth = 0, int vl = 0) {
+static void PopPvLine(const EngineStruct &eng, int nDepth = 0, int vl = 0) {
   uint16_t *lpwmv;
   uint32_t dwMoveStr;
+  const SearchStruct &Search = eng.Search;
+  SearchInfoStruct &Search2 = *eng.lpSearch2;
+  if (Search.bQuiet) {
+    return;
+  }
   // δﵽҪȣô¼ȺͷֵԺ
   if (nDepth > 0 && !Search2.bPopPv && !Search.bDebug) {
     Search2.nPopDepth = nDepth;
     Search2.vlPopValue = vl;
     return;
   }
-  // ʱ
-  printf("info time %d nodes %d\n", (int) (GetTime() - Search2.llTime), Search2.nAllNodes);
-  fflush(stdout);
   if (nDepth == 0) {
-    // Ѿô
+    // Ѿôֻʱ
     if (Search2.nPopDepth == 0) {
+      printf("info");
+      PopStats(eng);
+      printf("\n");
+      fflush(stdout);
       return;
     }
     // ȡǰûȺͷֵ
@@ -173,7 +320,9 @@ static void PopPvLine(int nDepth = 0, int vl = 0) {
     // ﵽҪȣôԺ󲻱
     Search2.nPopDepth = Search2.vlPopValue = 0;
   }
-  printf("info depth %d score %d pv", nDepth, vl);
+  printf("info depth %d seldepth %d score %d", nDepth, SelDepth(eng), vl);
+  PopStats(eng);
+  printf(" pv");
   lpwmv = Search2.wmvPvLine;
   while (*lpwmv != 0) {
     dwMoveStr = MOVE_COORD(*lpwmv);
@@ -184,6 +333,40 @@ static void PopPvLine(int nDepth = 0, int vl = 0) {
   fflush(stdout);
 }
 
+// Ҫ
+static void PopMultiPv(const EngineStruct &eng, int nDepth) {
+  int i;
+  uint16_t *lpwmv;
+  uint32_t dwMoveStr;
+  SearchInfoStruct &Search2 = *eng.lpSearch2;
+  if (eng.Search.bQuiet) {
+    return;
+  }
+  for (i = 0; i < Search2.nMultiPv; i ++) {
+    printf("info multipv %d depth %d seldepth %d score %d", i + 1, nDepth, SelDepth(eng), Search2.vlMultiPv[i]);
+    PopStats(eng);
+    printf(" pv");
+    lpwmv = (i == 0 ? Search2.wmvPvLine : Search2.wmvMultiPv[i - 1]);
+    while (*lpwmv != 0) {
+      dwMoveStr = MOVE_COORD(*lpwmv);
+      printf(" %.4s", (const char *) &dwMoveStr);
+      lpwmv ++;
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+}
+
+// ͳ߽߳Ϣ
+static void PopBound(const EngineStruct &eng, int nDepth, int vl, bool bLowerBound) {
+  if (!eng.Search.bQuiet && (eng.lpSearch2->bPopPv || eng.Search.bDebug)) {
+    printf("info depth %d seldepth %d score %d %s", nDepth, SelDepth(eng), vl, bLowerBound ? "lowerbound" : "upperbound");
+    PopStats(eng);
+    printf("\n");
+    fflush(stdout);
+  }
+}
+
 #endif
 
 // ޺ü
@@ -210,20 +393,32 @@ static int HarmlessPruning(const PositionStruct &pos, int vlBeta) {
   return -MATE_VALUE;
 }
 
-// ;ۺ
-inline int Evaluate(const PositionStruct &pos, int vlAlpha, int vlBeta) {
+// ;ۺÿ߳иԵľۻ
+inline int Evaluate(SearchThreadStruct &thd, int vlAlpha, int vlBeta) {
   int vl;
-  vl = Search.bKnowledge ? pos.Evaluate(vlAlpha, vlBeta) : pos.Material();
-  return vl == pos.DrawValue() ? vl - 1 : vl;
+  EvalCacheStruct *lpecs;
+  if (thd.lpeng->Search.bKnowledge) {
+    lpecs = thd.ecsTable + (thd.pos.zobr.dwKey & EVAL_CACHE_MASK);
+    thd.llEvalProbes ++;
+    if (lpecs->dwLock0 == thd.pos.zobr.dwLock0 && lpecs->dwLock1 == thd.pos.zobr.dwLock1) {
+      thd.llEvalHits ++;
+    }
+    vl = thd.pos.Evaluate(vlAlpha, vlBeta, *lpecs);
+  } else {
+    vl = thd.pos.Material();
+  }
+  return vl == thd.pos.DrawValue() ? vl - 1 : vl;
 }
 
 // ̬
-static int SearchQuiesc(PositionStruct &pos, int vlAlpha, int vlBeta) {
+static int SearchQuiesc(SearchThreadStruct &thd, int vlAlpha, int vlBeta) {
   int vlBest, vl, mv;
   bool bInCheck;
   MoveSortStruct MoveSort;  
+  PositionStruct &pos = thd.pos;
   // ̬̰¼裺
-  Search2.nAllNodes ++;
+  thd.llAllNodes ++;
+  thd.nSelDepth = MAX(thd.nSelDepth, pos.nDistance);
 
   // 1. ޺ü
   vl = HarmlessPruning(pos, vlBeta);
@@ -234,16 +429,16 @@ static int SearchQuiesc(PositionStruct &pos, int vlAlpha, int vlBeta) {
 #ifdef HASH_QUIESC
   // 3. ûü
   vl = ProbeHashQ(pos, vlAlpha, vlBeta);
-  if (Search.bUseHash && vl > -MATE_VALUE) {
+  if (thd.lpeng->Search.bUseHash && vl > -MATE_VALUE) {
     return vl;
   }
 #endif
 
   // 4. ﵽȣֱӷֵ
   if (pos.nDistance == LIMIT_DEPTH) {
-    return Evaluate(pos, vlAlpha, vlBeta);
+    return Evaluate(thd, vlAlpha, vlBeta);
   }
-  __ASSERT(Search.pos.nDistance < LIMIT_DEPTH);
+  __ASSERT(pos.nDistance < LIMIT_DEPTH);
 
   // 5. ʼ
   vlBest = -MATE_VALUE;
@@ -251,11 +446,11 @@ static int SearchQuiesc(PositionStruct &pos, int vlAlpha, int vlBeta) {
 
   // 6. ڱľ棬ȫŷ
   if (bInCheck) {
-    MoveSort.InitAll(pos);
+    MoveSort.InitAll(pos, thd.nHistory);
   } else {
 
     // 7. δľ棬ŷǰȳԿ()Ծۣ
-    vl = Evaluate(pos, vlAlpha, vlBeta);
+    vl = Evaluate(thd, vlAlpha, vlBeta);
     __ASSERT_BOUND(1 - WIN_VALUE, vl, WIN_VALUE - 1);
     __ASSERT(vl > vlBest);
     if (vl >= vlBeta) {
@@ -275,7 +470,7 @@ static int SearchQuiesc(PositionStruct &pos, int vlAlpha, int vlBeta) {
   while ((mv = MoveSort.NextQuiesc(bInCheck)) != 0) {
     __ASSERT(bInCheck || pos.ucpcSquares[DST(mv)] > 0);
     if (pos.MakeMove(mv)) {
-      vl = -SearchQuiesc(pos, -vlBeta, -vlAlpha);
+      vl = -SearchQuiesc(thd, -vlBeta, -vlAlpha);
       pos.UndoMakeMove();
       if (vl > vlBest) {
         if (vl >= vlBeta) {
@@ -309,10 +504,12 @@ static int SearchQuiesc(PositionStruct &pos, int vlAlpha, int vlBeta) {
 #ifndef CCHESS_A3800
 
 // UCCI֧ - ҶӽľϢ
-void PopLeaf(PositionStruct &pos) {
+void PopLeaf(EngineStruct &eng, PositionStruct &pos) {
   int vl;
-  Search2.nAllNodes = 0;
-  vl = SearchQuiesc(pos, -MATE_VALUE, MATE_VALUE);
+  SearchThreadStruct &thdMain = *eng.lpThreads[0];
+  thdMain.pos = pos;
+  thdMain.llAllNodes = 0;
+  vl = SearchQuiesc(thdMain, -MATE_VALUE, MATE_VALUE);
   printf("pophash lowerbound %d depth 0 upperbound %d depth 0\n", vl, vl);
   fflush(stdout);
 }
@@ -322,97 +519,114 @@ void PopLeaf(PositionStruct &pos) {
 const bool NO_NULL = true; // "SearchCut()"ĲǷֹŲü
 
 // 㴰ȫ
-static int SearchCut(int vlBeta, int nDepth, bool bNoNull = false) {
-  int nNewDepth, vlBest, vl;
+static int SearchCut(SearchThreadStruct &thd, int vlBeta, int nDepth, bool bNoNull = false) {
+  int nNewDepth, nReduction, nMoves, vlBest, vl;
   int mvHash, mv, mvEvade;
+  bool bInCheck;
   MoveSortStruct MoveSort;
+  const SearchStruct &Search = thd.lpeng->Search;
+  const SearchInfoStruct &Search2 = *thd.lpeng->lpSearch2;
   // ȫ̰¼裺
 
   // 1. Ҷӽ㴦þ̬
   if (nDepth <= 0) {
     __ASSERT(nDepth >= -NULL_DEPTH);
-    return SearchQuiesc(Search.pos, vlBeta - 1, vlBeta);
+    return SearchQuiesc(thd, vlBeta - 1, vlBeta);
   }
-  Search2.nAllNodes ++;
+  thd.llAllNodes ++;
 
   // 2. ޺ü
-  vl = HarmlessPruning(Search.pos, vlBeta);
+  vl = HarmlessPruning(thd.pos, vlBeta);
   if (vl > -MATE_VALUE) {
     return vl;
   }
 
   // 3. ûü
-  vl = ProbeHash(Search.pos, vlBeta - 1, vlBeta, nDepth, bNoNull, mvHash);
+  vl = ProbeHash(thd.pos, vlBeta - 1, vlBeta, nDepth, bNoNull, mvHash);
   if (Search.bUseHash && vl > -MATE_VALUE) {
     return vl;
   }
 
   // 4. ﵽȣֱӷֵ
-  if (Search.pos.nDistance == LIMIT_DEPTH) {
-    return Evaluate(Search.pos, vlBeta - 1, vlBeta);
+  if (thd.pos.nDistance == LIMIT_DEPTH) {
+    return Evaluate(thd, vlBeta - 1, vlBeta);
   }
-  __ASSERT(Search.pos.nDistance < LIMIT_DEPTH);
+  __ASSERT(thd.pos.nDistance < LIMIT_DEPTH);
 
   // 5. жϵã
-  Search2.nMainNodes ++;
+  thd.llMainNodes ++;
   vlBest = -MATE_VALUE;
-  if ((Search2.nMainNodes & Search.nCountMask) == 0 && Interrupt()) {
+  if ((thd.llMainNodes & Search.nCountMask) == 0 && Interrupt(thd)) {
     return vlBest;
   }
 
   // 6. ԿŲü
-  if (Search.bNullMove && !bNoNull && Search.pos.LastMove().ChkChs <= 0 && Search.pos.NullOkay()) {
-    Search.pos.NullMove();
-    vl = -SearchCut(1 - vlBeta, nDepth - NULL_DEPTH - 1, NO_NULL);
-    Search.pos.UndoNullMove();
+  if (Search.bNullMove && !bNoNull && thd.pos.LastMove().ChkChs <= 0 && thd.pos.NullOkay()) {
+    thd.pos.NullMove(nDepth > NULL_DEPTH + 1);
+    vl = -SearchCut(thd, 1 - vlBeta, nDepth - NULL_DEPTH - 1, NO_NULL);
+    thd.pos.UndoNullMove();
     if (Search2.bStop) {
       return vlBest;
     }
 
     if (vl >= vlBeta) {
-      if (Search.pos.NullSafe()) {
+      if (thd.pos.NullSafe()) {
         // a. Ųü飬ô¼Ϊ(NULL_DEPTH + 1)
-        RecordHash(Search.pos, HASH_BETA, vl, MAX(nDepth, NULL_DEPTH + 1), 0);
+        RecordHash(thd.pos, HASH_BETA, vl, MAX(nDepth, NULL_DEPTH + 1), 0);
         return vl;
-      } else if (SearchCut(vlBeta, nDepth - NULL_DEPTH, NO_NULL) >= vlBeta) {
+      } else if (SearchCut(thd, vlBeta, nDepth - NULL_DEPTH, NO_NULL) >= vlBeta) {
         // b. Ųü飬ô¼Ϊ(NULL_DEPTH)
-        RecordHash(Search.pos, HASH_BETA, vl, MAX(nDepth, NULL_DEPTH), 0);
+        RecordHash(thd.pos, HASH_BETA, vl, MAX(nDepth, NULL_DEPTH), 0);
         return vl;
       }
     }
   }
 
   // 7. ʼ
-  if (Search.pos.LastMove().ChkChs > 0) {
+  nMoves = 0;
+  bInCheck = (thd.pos.LastMove().ChkChs > 0);
+  if (bInCheck) {
     // ǽ棬ôӦŷ
-    mvEvade = MoveSort.InitEvade(Search.pos, mvHash, Search2.wmvKiller[Search.pos.nDistance]);
+    mvEvade = MoveSort.InitEvade(thd.pos, mvHash, thd.wmvKiller[thd.pos.nDistance], thd.nHistory);
   } else {
     // ǽ棬ôʹŷб
-    MoveSort.InitFull(Search.pos, mvHash, Search2.wmvKiller[Search.pos.nDistance]);
+    MoveSort.InitFull(thd.pos, mvHash, thd.wmvKiller[thd.pos.nDistance], thd.nHistory);
     mvEvade = 0;
   }
 
   // 8. "MoveSortStruct::NextFull()"̵ŷ˳һ
-  while ((mv = MoveSort.NextFull(Search.pos)) != 0) {
-    if (Search.pos.MakeMove(mv)) {
+  while ((mv = MoveSort.NextFull(thd.pos)) != 0) {
+    if (thd.pos.MakeMove(mv, nDepth > 1)) {
 
       // 9. ѡ죻
-      nNewDepth = (Search.pos.LastMove().ChkChs > 0 || mvEvade != 0 ? nDepth : nDepth - 1);
+      nMoves ++;
+      nNewDepth = (thd.pos.LastMove().ChkChs > 0 || mvEvade != 0 ? nDepth : nDepth - 1);
+
+      // 10. ŷȣӦʱʷ׶￿Ĳӡ׽ӵŷüһ
+      // ȽϴʱʷֵΪ(δض)ŷٶһ㣬ֻи߽߳ʱ
+      nReduction = 0;
+      if (!bInCheck && MoveSort.nPhase == PHASE_REST && nDepth >= REDUCTION_DEPTH && nMoves > REDUCTION_MOVES &&
+          thd.pos.LastMove().CptDrw <= 0 && thd.pos.LastChkChs() == 0) {
+        nReduction = (nDepth >= REDUCTION_DEPTH * 2 && nMoves > REDUCTION_MOVES * 3 && thd.nHistory[mv] == 0 ? 2 : 1);
+      }
 
-      // 10. 㴰
-      vl = -SearchCut(1 - vlBeta, nNewDepth);
-      Search.pos.UndoMakeMove();
+      // 11. 㴰
+      vl = -SearchCut(thd, 1 - vlBeta, nNewDepth - nReduction);
+      if (nReduction > 0 && vl >= vlBeta && !Search2.bStop) {
+        vl = -SearchCut(thd, 1 - vlBeta, nNewDepth);
+      }
+      thd.pos.UndoMakeMove();
       if (Search2.bStop) {
         return vlBest;
       }
 
-      // 11. ضж
+      // 12. ضж
       if (vl > vlBest) {
         vlBest = vl;
         if (vl >= vlBeta) {
-          RecordHash(Search.pos, HASH_BETA, vlBest, nDepth, mv);
-          if (!MoveSort.GoodCap(Search.pos, mv)) {
-            SetBestMove(mv, nDepth, Search2.wmvKiller[Search.pos.nDistance]);
+          RecordHash(thd.pos, HASH_BETA, vlBest, nDepth, mv);
+          if (!MoveSort.GoodCap(thd.pos, mv)) {
+            SetBestMove(mv, nDepth, thd.wmvKiller[thd.pos.nDistance], thd.nHistory);
           }
           return vlBest;
         }
@@ -420,12 +634,12 @@ static int SearchCut(int vlBeta, int nDepth, bool bNoNull = false) {
     }
   }
 
-  // 12. ضϴʩ
+  // 13. ضϴʩ
   if (vlBest == -MATE_VALUE) {
-    __ASSERT(Search.pos.IsMate());
-    return Search.pos.nDistance - MATE_VALUE;
+    __ASSERT(thd.pos.IsMate());
+    return thd.pos.nDistance - MATE_VALUE;
   } else {
-    RecordHash(Search.pos, HASH_ALPHA, vlBest, nDepth, mvEvade);
+    RecordHash(thd.pos, HASH_ALPHA, vlBest, nDepth, mvEvade);
     return vlBest;
   }
 }
@@ -450,54 +664,56 @@ static void AppendPvLine(uint16_t *lpwmvDst, uint16_t mv, const uint16_t *lpwmvS
  * 4. PVҪȡҪ
  * 5. PV㴦ŷ
  */
-static int SearchPV(int vlAlpha, int vlBeta, int nDepth, uint16_t *lpwmvPvLine) {
+static int SearchPV(SearchThreadStruct &thd, int vlAlpha, int vlBeta, int nDepth, uint16_t *lpwmvPvLine) {
   int nNewDepth, nHashFlag, vlBest, vl;
   int mvBest, mvHash, mv, mvEvade;
   MoveSortStruct MoveSort;
   uint16_t wmvPvLine[LIMIT_DEPTH];
+  const SearchStruct &Search = thd.lpeng->Search;
+  const SearchInfoStruct &Search2 = *thd.lpeng->lpSearch2;
   // ȫ̰¼裺
 
   // 1. Ҷӽ㴦þ̬
   *lpwmvPvLine = 0;
   if (nDepth <= 0) {
     __ASSERT(nDepth >= -NULL_DEPTH);
-    return SearchQuiesc(Search.pos, vlAlpha, vlBeta);
+    return SearchQuiesc(thd, vlAlpha, vlBeta);
   }
-  Search2.nAllNodes ++;
+  thd.llAllNodes ++;
 
   // 2. ޺ü
-  vl = HarmlessPruning(Search.pos, vlBeta);
+  vl = HarmlessPruning(thd.pos, vlBeta);
   if (vl > -MATE_VALUE) {
     return vl;
   }
 
   // 3. ûü
-  vl = ProbeHash(Search.pos, vlAlpha, vlBeta, nDepth, NO_NULL, mvHash);
+  vl = ProbeHash(thd.pos, vlAlpha, vlBeta, nDepth, NO_NULL, mvHash);
   if (Search.bUseHash && vl > -MATE_VALUE) {
     // PV㲻ûüԲᷢPV·жϵ
     return vl;
   }
 
   // 4. ﵽȣֱӷֵ
-  __ASSERT(Search.pos.nDistance > 0);
-  if (Search.pos.nDistance == LIMIT_DEPTH) {
-    return Evaluate(Search.pos, vlAlpha, vlBeta);
+  __ASSERT(thd.pos.nDistance > 0);
+  if (thd.pos.nDistance == LIMIT_DEPTH) {
+    return Evaluate(thd, vlAlpha, vlBeta);
   }
-  __ASSERT(Search.pos.nDistance < LIMIT_DEPTH);
+  __ASSERT(thd.pos.nDistance < LIMIT_DEPTH);
 
   // 5. жϵã
-  Search2.nMainNodes ++;
+  thd.llMainNodes ++;
   vlBest = -MATE_VALUE;
-  if ((Search2.nMainNodes & Search.nCountMask) == 0 && Interrupt()) {
+  if ((thd.llMainNodes & Search.nCountMask) == 0 && Interrupt(thd)) {
     return vlBest;
   }
 
   // 6. ڲ
   if (nDepth > IID_DEPTH && mvHash == 0) {
     __ASSERT(nDepth / 2 <= nDepth - IID_DEPTH);
-    vl = SearchPV(vlAlpha, vlBeta, nDepth / 2, wmvPvLine);
+    vl = SearchPV(thd, vlAlpha, vlBeta, nDepth / 2, wmvPvLine);
     if (vl <= vlAlpha) {
-      vl = SearchPV(-MATE_VALUE, vlBeta, nDepth / 2, wmvPvLine);
+      vl = SearchPV(thd, -MATE_VALUE, vlBeta, nDepth / 2, wmvPvLine);
     }
     if (Search2.bStop) {
       return vlBest;
@@ -508,32 +724,32 @@ static int SearchPV(int vlAlpha, int vlBeta, int nDepth, uint16_t *lpwmvPvLine)
   // 7. ʼ
   mvBest = 0;
   nHashFlag = HASH_ALPHA;
-  if (Search.pos.LastMove().ChkChs > 0) {
+  if (thd.pos.LastMove().ChkChs > 0) {
     // ǽ棬ôӦŷ
-    mvEvade = MoveSort.InitEvade(Search.pos, mvHash, Search2.wmvKiller[Search.pos.nDistance]);
+    mvEvade = MoveSort.InitEvade(thd.pos, mvHash, thd.wmvKiller[thd.pos.nDistance], thd.nHistory);
   } else {
     // ǽ棬ôʹŷб
-    MoveSort.InitFull(Search.pos, mvHash, Search2.wmvKiller[Search.pos.nDistance]);
+    MoveSort.InitFull(thd.pos, mvHash, thd.wmvKiller[thd.pos.nDistance], thd.nHistory);
     mvEvade = 0;
   }
 
   // 8. "MoveSortStruct::NextFull()"̵ŷ˳һ
-  while ((mv = MoveSort.NextFull(Search.pos)) != 0) {
-    if (Search.pos.MakeMove(mv)) {
+  while ((mv = MoveSort.NextFull(thd.pos)) != 0) {
+    if (thd.pos.MakeMove(mv, nDepth > 1)) {
 
       // 9. ѡ죻
-      nNewDepth = (Search.pos.LastMove().ChkChs > 0 || mvEvade != 0 ? nDepth : nDepth - 1);
+      nNewDepth = (thd.pos.LastMove().ChkChs > 0 || mvEvade != 0 ? nDepth : nDepth - 1);
 
       // 10. Ҫ
       if (vlBest == -MATE_VALUE) {
-        vl = -SearchPV(-vlBeta, -vlAlpha, nNewDepth, wmvPvLine);
+        vl = -SearchPV(thd, -vlBeta, -vlAlpha, nNewDepth, wmvPvLine);
       } else {
-        vl = -SearchCut(-vlAlpha, nNewDepth);
+        vl = -SearchCut(thd, -vlAlpha, nNewDepth);
         if (vl > vlAlpha && vl < vlBeta) {
-          vl = -SearchPV(-vlBeta, -vlAlpha, nNewDepth, wmvPvLine);
+          vl = -SearchPV(thd, -vlBeta, -vlAlpha, nNewDepth, wmvPvLine);
         }
       }
-      Search.pos.UndoMakeMove();
+      thd.pos.UndoMakeMove();
       if (Search2.bStop) {
         return vlBest;
       }
@@ -558,12 +774,12 @@ static int SearchPV(int vlAlpha, int vlBeta, int nDepth, uint16_t *lpwmvPvLine)
 
   // 12. ûʷɱŷ
   if (vlBest == -MATE_VALUE) {
-    __ASSERT(Search.pos.IsMate());
-    return Search.pos.nDistance - MATE_VALUE;
+    __ASSERT(thd.pos.IsMate());
+    return thd.pos.nDistance - MATE_VALUE;
   } else {
-    RecordHash(Search.pos, nHashFlag, vlBest, nDepth, mvEvade == 0 ? mvBest : mvEvade);
-    if (mvBest != 0 && !MoveSort.GoodCap(Search.pos, mvBest)) {
-      SetBestMove(mvBest, nDepth, Search2.wmvKiller[Search.pos.nDistance]);
+    RecordHash(thd.pos, nHashFlag, vlBest, nDepth, mvEvade == 0 ? mvBest : mvEvade);
+    if (mvBest != 0 && !MoveSort.GoodCap(thd.pos, mvBest)) {
+      SetBestMove(mvBest, nDepth, thd.wmvKiller[thd.pos.nDistance], thd.nHistory);
     }
     return vlBest;
   }
@@ -576,26 +792,32 @@ static int SearchPV(int vlAlpha, int vlBeta, int nDepth, uint16_t *lpwmvPvLine)
  * 3. ѡֻʹý죻
  * 4. ˵ֹŷ
  * 5. ŷʱҪܶദ(¼Ҫ)
- * 6. ʷɱŷ
+ * 6. ʷɱŷ
+ * 7. ʹÿڣ߽߳ʱأͳ߽ʱıҪ"SearchMain()"ſ
+ *    "δıŷ"ļҲ"SearchMain()"ڴȷԺ£
+ * 8. Ҫģʽ£"nPvIndex + 1"Ҫʱǰ漸Ҫŷ
  */
-static int SearchRoot(int nDepth) {
+static int SearchRoot(SearchThreadStruct &thd, int nDepth, int vlAlpha = -MATE_VALUE, int vlBeta = MATE_VALUE, int nPvIndex = 0) {
   int nNewDepth, vlBest, vl, mv, nCurrMove;
 #ifndef CCHESS_A3800
   uint32_t dwMoveStr;
 #endif
   uint16_t wmvPvLine[LIMIT_DEPTH];
+  EngineStruct &eng = *thd.lpeng;
+  SearchStruct &Search = eng.Search;
+  SearchInfoStruct &Search2 = *eng.lpSearch2;
   // ̰¼裺
 
   // 1. ʼ
   vlBest = -MATE_VALUE;
-  Search2.MoveSort.ResetRoot();
+  thd.MoveSort.ResetRoot(false, nPvIndex);
 
   // 2. һÿŷ(Ҫ˽ֹŷ)
   nCurrMove = 0;
-  while ((mv = Search2.MoveSort.NextRoot()) != 0) {
-    if (Search.pos.MakeMove(mv)) {
+  while ((mv = thd.MoveSort.NextRoot()) != 0) {
+    if (thd.pos.MakeMove(mv, nDepth > 1)) {
 #ifndef CCHESS_A3800
-      if (Search2.bPopCurrMove || Search.bDebug) {
+      if (thd.nThread == 0 && !Search.bQuiet && (Search2.bPopCurrMove || Search.bDebug)) {
         dwMoveStr = MOVE_COORD(mv);
         nCurrMove ++;
         printf("info currmove %.4s currmovenumber %d\n", (const char *) &dwMoveStr, nCurrMove);
@@ -604,45 +826,62 @@ static int SearchRoot(int nDepth) {
 #endif
 
       // 3. ѡ(ֻǽ)
-      nNewDepth = (Search.pos.LastMove().ChkChs > 0 ? nDepth : nDepth - 1);
+      nNewDepth = (thd.pos.LastMove().ChkChs > 0 ? nDepth : nDepth - 1);
 
       // 4. Ҫ
       if (vlBest == -MATE_VALUE) {
-        vl = -SearchPV(-MATE_VALUE, MATE_VALUE, nNewDepth, wmvPvLine);
-        __ASSERT(vl > vlBest);
+        vl = -SearchPV(thd, -vlBeta, -vlAlpha, nNewDepth, wmvPvLine);
       } else {
-        vl = -SearchCut(-vlBest, nNewDepth);
-        if (vl > vlBest) { // ﲻҪ" && vl < MATE_VALUE"
-          vl = -SearchPV(-MATE_VALUE, -vlBest, nNewDepth, wmvPvLine);
+        vl = -SearchCut(thd, -vlAlpha, nNewDepth);
+        if (vl > vlAlpha) { // ﲻҪ" && vl < vlBeta"ˣ߽߳ŷҲҪȡҪ
+          vl = -SearchPV(thd, -vlBeta, -vlAlpha, nNewDepth, wmvPvLine);
         }
       }
-      Search.pos.UndoMakeMove();
+      thd.pos.UndoMakeMove();
       if (Search2.bStop) {
         return vlBest;
       }
 
-      // 5. Alpha-Beta߽ж("vlBest""SearchPV()"е"vlAlpha")
-      if (vl > vlBest) {
+      // 5. Alpha-Beta߽ж("vlBest"ڵͳ߽ʱҲҪ¼Ϊصϱ߽)
+      if (vl > vlAlpha) {
 
-        // 6. һŷô"δıŷ"ļ1
-        Search2.nUnchanged = (vlBest == -MATE_VALUE ? Search2.nUnchanged + 1 : 0);
+        // ֻ߳Ҫ¸ŷб
+        if (thd.nThread > 0) {
+          vlBest = vlAlpha = vl;
+          thd.MoveSort.UpdateRoot(mv);
+          if (vl >= vlBeta) {
+            return vl;
+          }
+          continue;
+        }
         vlBest = vl;
 
-        // 7. ŷʱ¼Ҫ
-        AppendPvLine(Search2.wmvPvLine, mv, wmvPvLine);
+        // 6. ŷʱ¼Ҫ߽߳ʱأ"SearchMain()"±߽
+        AppendPvLine(nPvIndex == 0 ? Search2.wmvPvLine : Search2.wmvMultiPv[nPvIndex - 1], mv, wmvPvLine);
+        if (vl >= vlBeta) {
+          thd.MoveSort.UpdateRoot(mv, nPvIndex);
+          return vl;
+        }
 #ifndef CCHESS_A3800
-        PopPvLine(nDepth, vl);
+        // ҪҪһεȫɺ"SearchMain()"
+        if (Search.nMultiPv <= 1) {
+          PopPvLine(eng, nDepth, vl);
+        }
 #endif
 
-        // 8. ҪԣAlphaֵҪɱʱ
+        // 7. ҪԣAlphaֵҪɱʱֵڴ
         if (vlBest > -WIN_VALUE && vlBest < WIN_VALUE) {
           vlBest += (Search.rc4Random.NextLong() & Search.nRandomMask) -
               (Search.rc4Random.NextLong() & Search.nRandomMask);
-          vlBest = (vlBest == Search.pos.DrawValue() ? vlBest - 1 : vlBest);
+          vlBest = (vlBest == thd.pos.DrawValue() ? vlBest - 1 : vlBest);
+          vlBest = MIN(MAX(vlBest, vlAlpha + 1), vlBeta - 1);
         }
+        vlAlpha = vlBest;
 
-        // 9. ¸ŷб
-        Search2.MoveSort.UpdateRoot(mv);
+        // 8. ¸ŷб
+        thd.MoveSort.UpdateRoot(mv, nPvIndex);
+      } else if (vl > vlBest) {
+        vlBest = vl;
       }
     }
   }
@@ -652,14 +891,15 @@ static int SearchRoot(int nDepth) {
 // ΨһŷElephantEyeϵһɫжĳȽеǷҵΨһŷ
 // ԭǰҵŷɽֹŷȻ(-WIN_VALUE, 1 - WIN_VALUE)Ĵ
 // ͳ߽˵ŷɱ
-static bool SearchUnique(int vlBeta, int nDepth) {
+static bool SearchUnique(SearchThreadStruct &thd, int vlBeta, int nDepth) {
   int vl, mv;
-  Search2.MoveSort.ResetRoot(ROOT_UNIQUE);
+  const SearchInfoStruct &Search2 = *thd.lpeng->lpSearch2;
+  thd.MoveSort.ResetRoot(ROOT_UNIQUE);
   // һŷ
-  while ((mv = Search2.MoveSort.NextRoot()) != 0) {
-    if (Search.pos.MakeMove(mv)) {
-      vl = -SearchCut(1 - vlBeta, Search.pos.LastMove().ChkChs > 0 ? nDepth : nDepth - 1);
-      Search.pos.UndoMakeMove();
+  while ((mv = thd.MoveSort.NextRoot()) != 0) {
+    if (thd.pos.MakeMove(mv, nDepth > 1)) {
+      vl = -SearchCut(thd, 1 - vlBeta, thd.pos.LastMove().ChkChs > 0 ? nDepth : nDepth - 1);
+      thd.pos.UndoMakeMove();
       if (Search2.bStop || vl >= vlBeta) {
         return false;
       }
@@ -668,23 +908,129 @@ static bool SearchUnique(int vlBeta, int nDepth) {
   return true;
 }
 
+#ifndef CCHESS_A3800
+
+// ̵߳ڣ̴߳һֱڣʱȴ̷߳ͷʵʱ˳
+static void *HelperEntry(void *lpParameter) {
+  int i;
+  SearchThreadStruct &thd = *(SearchThreadStruct *) lpParameter;
+  while (true) {
+    thd.evStart.Wait();
+    if (thd.bExit) {
+      return NULL;
+    }
+    MemFence();
+    // ߳Ҳ̱߳ż̶߳һ㣬ʹ̴߳
+    for (i = SMP_DEPTH + (thd.nThread & 1); i <= thd.nDepth; i ++) {
+      SearchRoot(thd, i);
+      if (thd.lpeng->lpSearch2->bStop) {
+        break;
+      }
+    }
+    MemFence();
+    thd.bBusy = false;
+  }
+  return NULL;
+}
+
+// ߳ĸ߳ĸ̲߳ٷ
+void SetThreads(EngineStruct &eng, int nThreadNum) {
+  SearchThreadStruct *lpthd;
+  nThreadNum = MIN(MAX(nThreadNum, 1), MAX_THREADS);
+  while (eng.nThreadsStarted < nThreadNum) {
+    lpthd = NewThread(eng, eng.nThreadsStarted);
+    eng.lpThreads[eng.nThreadsStarted] = lpthd;
+    eng.nThreadsStarted ++;
+    lpthd->evStart.Init();
+    lpthd->Thread.Start(HelperEntry, lpthd);
+  }
+  eng.nThreads = nThreadNum;
+}
+
+// ø̴߳Ӹ㿪ʼ
+static void StartHelpers(EngineStruct &eng, int nDepth) {
+  int i;
+  SearchThreadStruct *lpthd;
+  for (i = 1; i < eng.nThreads; i ++) {
+    lpthd = eng.lpThreads[i];
+    __ASSERT(!lpthd->bBusy);
+    lpthd->pos = eng.Search.pos;
+    lpthd->nDepth = nDepth;
+    lpthd->MoveSort = eng.lpThreads[0]->MoveSort;
+    MemFence();
+    lpthd->bBusy = true;
+    lpthd->evStart.Set();
+  }
+}
+
+// ̵ֹ߳ȴи߳̿
+static void StopHelpers(EngineStruct &eng) {
+  int i;
+  eng.lpSearch2->bStop = true;
+  for (i = 1; i < eng.nThreads; i ++) {
+    while (eng.lpThreads[i]->bBusy) {
+      Idle();
+    }
+  }
+}
+
+#endif
+
+void DelEngine(EngineStruct &eng) {
+  int i;
+  // ̶߳ǿеģ֪ͨ˳ǽͷ߳Ϣ
+  for (i = 1; i < eng.nThreadsStarted; i ++) {
+    __ASSERT(!eng.lpThreads[i]->bBusy);
+    eng.lpThreads[i]->bExit = true;
+    eng.lpThreads[i]->evStart.Set();
+  }
+  for (i = 1; i < eng.nThreadsStarted; i ++) {
+    eng.lpThreads[i]->Thread.Join();
+    eng.lpThreads[i]->evStart.Destroy();
+    delete eng.lpThreads[i];
+  }
+  delete eng.lpThreads[0];
+  delete eng.lpSearch2;
+  eng.nThreads = eng.nThreadsStarted = 0;
+  DelHash(eng.Hash);
+#ifndef CCHESS_A3800
+  DelBooks(eng.Books);
+#endif
+}
+
+// µ֣ûʷ
+void NewGame(EngineStruct &eng) {
+  int i;
+  for (i = 0; i < eng.nThreadsStarted; i ++) {
+    ClearHistory(eng.lpThreads[i]->nHistory);
+  }
+  ClearHash(eng.Hash);
+}
+
 // 
-void SearchMain(int nDepth) {
-  int i, vl, vlLast, nDraw;
-  int nCurrTimer, nLimitTimer, nLimitNodes;
+void SearchMain(EngineStruct &eng, int nDepth) {
+  int i, vl, vlLast, mvLast, vlAlpha, vlBeta, nWindow, nDraw;
+  int nCurrTimer, nLimitTimer;
+  int64_t llLimitNodes;
   bool bUnique;
 #ifndef CCHESS_A3800
   int nBookMoves;
   uint32_t dwMoveStr;
   BookStruct bks[MAX_GEN_MOVES];
 #endif
+  SearchStruct &Search = eng.Search;
+  SearchInfoStruct &Search2 = *eng.lpSearch2;
+  SearchThreadStruct &thdMain = *eng.lpThreads[0];
   // ̰¼裺
 
   // 1. ֱӷ
+  Search.mvResult = 0;
   if (Search.pos.IsDraw() || Search.pos.RepStatus(3) > 0) {
 #ifndef CCHESS_A3800
-    printf("nobestmove\n");
-    fflush(stdout);
+    if (!Search.bQuiet) {
+      printf("nobestmove\n");
+      fflush(stdout);
+    }
 #endif
     return;    
   }
@@ -693,14 +1039,16 @@ void SearchMain(int nDepth) {
   // 2. ӿֿŷ
   if (Search.bUseBook) {
     // a. ȡֿе߷
-    nBookMoves = GetBookMoves(Search.pos, Search.szBookFile, bks);
+    nBookMoves = GetBookMoves(Search.pos, eng.Books, bks);
     if (nBookMoves > 0) {
       vl = 0;
       for (i = 0; i < nBookMoves; i ++) {
         vl += bks[i].wvl;
-        dwMoveStr = MOVE_COORD(bks[i].wmv);
-        printf("info depth 0 score %d pv %.4s\n", bks[i].wvl, (const char *) &dwMoveStr);
-        fflush(stdout);
+        if (!Search.bQuiet) {
+          dwMoveStr = MOVE_COORD(bks[i].wmv);
+          printf("info depth 0 score %d pv %.4s\n", bks[i].wvl, (const char *) &dwMoveStr);
+          fflush(stdout);
+        }
       }
       // b. Ȩѡһ߷
       vl = Search.rc4Random.NextLong() % (uint32_t) vl;
@@ -715,10 +1063,15 @@ void SearchMain(int nDepth) {
       // c. ֿеŷѭ棬ôŷ
       Search.pos.MakeMove(bks[i].wmv);
       if (Search.pos.RepStatus(3) == 0) {
+        Search.mvResult = bks[i].wmv;
+        if (Search.bQuiet) {
+          Search.pos.UndoMakeMove();
+          return;
+        }
         dwMoveStr = MOVE_COORD(bks[i].wmv);
         printf("bestmove %.4s", (const char *) &dwMoveStr);
         // d. ̨˼ŷ(ֿеһȨĺŷ)
-        nBookMoves = GetBookMoves(Search.pos, Search.szBookFile, bks);
+        nBookMoves = GetBookMoves(Search.pos, eng.Books, bks);
         Search.pos.UndoMakeMove();
         if (nBookMoves > 0) {
           dwMoveStr = MOVE_COORD(bks[0].wmv);
@@ -736,28 +1089,51 @@ void SearchMain(int nDepth) {
   // 3. Ϊ򷵻ؾֵ̬
   if (nDepth == 0) {
 #ifndef CCHESS_A3800
-    printf("info depth 0 score %d\n", SearchQuiesc(Search.pos, -MATE_VALUE, MATE_VALUE));
-    fflush(stdout);
-    printf("nobestmove\n");
-    fflush(stdout);
+    if (!Search.bQuiet) {
+      thdMain.pos = Search.pos;
+      printf("info depth 0 score %d\n", SearchQuiesc(thdMain, -MATE_VALUE, MATE_VALUE));
+      fflush(stdout);
+      printf("nobestmove\n");
+      fflush(stdout);
+    }
 #endif
     return;
   }
 
   // 4. ɸÿŷ
-  Search2.MoveSort.InitRoot(Search.pos, Search.nBanMoves, Search.wmvBanList);
+  thdMain.pos = Search.pos;
+  thdMain.MoveSort.InitRoot(thdMain.pos, Search.nBanMoves, Search.wmvBanList);
 
   // 5. ʼʱͼ
   Search2.bStop = Search2.bPonderStop = Search2.bPopPv = Search2.bPopCurrMove = false;
   Search2.nPopDepth = Search2.vlPopValue = 0;
-  Search2.nAllNodes = Search2.nMainNodes = Search2.nUnchanged = 0;
+  Search2.nUnchanged = 0;
   Search2.wmvPvLine[0] = 0;
-  ClearKiller(Search2.wmvKiller);
-  ClearHistory();
-  ClearHash();
-  //  ClearHash() Ҫһʱ䣬ԼʱԺʼȽϺ
+#ifndef CCHESS_A3800
+  // ģʽʱֱ߳Ӵ"stop""ponderhit"ָģʽʵӴ߳
+  if (!Search.bBatch) {
+    UcciBusy.lpbStop = &Search2.bStop;
+    UcciBusy.bPonderHit = UcciBusy.bDraw = false;
+    MemFence();
+    UcciBusy.bBusy = true;
+  }
+#endif
+  for (i = 0; i < eng.nThreads; i ++) {
+    eng.lpThreads[i]->llAllNodes = eng.lpThreads[i]->llMainNodes = 0;
+    eng.lpThreads[i]->llEvalProbes = eng.lpThreads[i]->llEvalHits = 0;
+    eng.lpThreads[i]->nSelDepth = 0;
+  }
+  // ûʷǰϢֻµֲ("NewGame()")
+  // ɱŷǰľ洢ģ˸ûˣ
+  // ۻھԤ۵ĽÿǰԤۣҲҪ
+  for (i = 0; i < eng.nThreads; i ++) {
+    ClearKiller(eng.lpThreads[i]->wmvKiller);
+    AgeHistory(eng.lpThreads[i]->nHistory);
+    memset(eng.lpThreads[i]->ecsTable, 0, sizeof(eng.lpThreads[i]->ecsTable));
+  }
+  NewHashAge(eng.Hash);
   Search2.llTime = GetTime();
-  vlLast = 0;
+  vlLast = mvLast = 0;
   // 10غŷôͣԺÿ8غһ
   nDraw = -Search.pos.LastMove().CptDrw;
   if (nDraw > 5 && ((nDraw - 4) / 2) % 8 == 0) {
@@ -770,7 +1146,7 @@ void SearchMain(int nDepth) {
   for (i = 1; i <= nDepth; i ++) {
     // ҪҪʱһ"info depth n"ǲ
 #ifndef CCHESS_A3800
-    if (Search2.bPopPv || Search.bDebug) {
+    if (!Search.bQuiet && (Search2.bPopPv || Search.bDebug)) {
       printf("info depth %d\n", i);
       fflush(stdout);
     }
@@ -780,14 +1156,63 @@ void SearchMain(int nDepth) {
     Search2.bPopCurrMove = (nCurrTimer > 3000);
 #endif
 
-    // 8. 
-    vl = SearchRoot(i);
+#ifndef CCHESS_A3800
+    // ﵽȣø̲߳
+    if (i == SMP_DEPTH && eng.nThreads > 1) {
+      StartHelpers(eng, nDepth);
+    }
+#endif
+
+    // 8. 㣬ﵽһȺʹһֵΪĵĿڣͳ߽߳ʱſ
+    // Ҫģʽ£ȫÿҪÿζǰѾҵŷ
+    if (Search.nMultiPv > 1) {
+      vl = SearchRoot(thdMain, i);
+      Search2.vlMultiPv[0] = vl;
+      Search2.nMultiPv = 1;
+      while (!Search2.bStop && Search2.nMultiPv < Search.nMultiPv) {
+        Search2.vlMultiPv[Search2.nMultiPv] = SearchRoot(thdMain, i, -MATE_VALUE, MATE_VALUE, Search2.nMultiPv);
+        // ûʣµĺŷ
+        if (Search2.vlMultiPv[Search2.nMultiPv] == -MATE_VALUE) {
+          break;
+        }
+        Search2.nMultiPv ++;
+      }
+#ifndef CCHESS_A3800
+      if (!Search2.bStop) {
+        PopMultiPv(eng, i);
+      }
+#endif
+    } else if (i < ASPIRATION_DEPTH || vlLast <= -WIN_VALUE || vlLast >= WIN_VALUE) {
+      vl = SearchRoot(thdMain, i);
+    } else {
+      nWindow = ASPIRATION_WINDOW;
+      vlAlpha = vlLast - nWindow;
+      vlBeta = vlLast + nWindow;
+      while (true) {
+        vl = SearchRoot(thdMain, i, vlAlpha, vlBeta);
+        if (Search2.bStop || (vl > vlAlpha && vl < vlBeta)) {
+          break;
+        }
+#ifndef CCHESS_A3800
+        PopBound(eng, i, vl, vl >= vlBeta);
+#endif
+        nWindow *= 2;
+        if (vl <= vlAlpha) {
+          vlAlpha = (nWindow > WIN_VALUE ? -MATE_VALUE : MAX(vl - nWindow, -MATE_VALUE));
+        } else {
+          vlBeta = (nWindow > WIN_VALUE ? MATE_VALUE : MIN(vl + nWindow, MATE_VALUE));
+        }
+      }
+    }
     if (Search2.bStop) {
       if (vl > -MATE_VALUE) {
         vlLast = vl; // vlLastжͶҪһֵ
       }
       break; // û"vl"ǿɿֵ
     }
+    // ŷһһô"δıŷ"ļ1
+    Search2.nUnchanged = (Search2.wmvPvLine[0] == mvLast ? Search2.nUnchanged + 1 : 0);
+    mvLast = Search2.wmvPvLine[0];
 
     nCurrTimer = (int) (GetTime() - Search2.llTime);
     // 9. ʱ䳬ʵʱޣֹ
@@ -807,12 +1232,12 @@ void SearchMain(int nDepth) {
         }
       }
     } else if (Search.nGoMode == GO_MODE_NODES) {
-      // nLimitNodesļ㷽nLimitTimerһ
-      nLimitNodes = (Search.bNullMove ? Search.nNodes : Search.nNodes / 2);
-      nLimitNodes = (vl + DROPDOWN_VALUE >= vlLast ? nLimitNodes / 2 : nLimitNodes);
-      nLimitNodes = (Search2.nUnchanged >= UNCHANGED_DEPTH ? nLimitNodes / 2 : nLimitNodes);
+      // llLimitNodesļ㷽nLimitTimerһ
+      llLimitNodes = (Search.bNullMove ? Search.llNodes : Search.llNodes / 2);
+      llLimitNodes = (vl + DROPDOWN_VALUE >= vlLast ? llLimitNodes / 2 : llLimitNodes);
+      llLimitNodes = (Search2.nUnchanged >= UNCHANGED_DEPTH ? llLimitNodes / 2 : llLimitNodes);
       // GO_MODE_NODESǲӳ̨˼ʱ
-      if (Search2.nAllNodes > nLimitNodes) {
+      if (AllNodes(eng) > llLimitNodes) {
         vlLast = vl;
         break;
       }
@@ -824,19 +1249,32 @@ void SearchMain(int nDepth) {
       break;
     }
 
-    // 11. Ψһŷֹ
-    if (SearchUnique(1 - WIN_VALUE, i)) {
+    // 11. Ψһŷֹ(ҪģʽҪҪԲΨһŷ)
+    if (Search.nMultiPv <= 1 && SearchUnique(thdMain, 1 - WIN_VALUE, i)) {
       bUnique = true;
       break;
     }
   }
 
-#ifdef CCHESS_A3800
+#ifndef CCHESS_A3800
+  // ߳󣬸߳ҲҪֱֹ̲߳Ӵָ
+  StopHelpers(eng);
+  if (!Search.bBatch) {
+    UcciBusy.bBusy = false;
+  }
+#endif
+
   Search.mvResult = Search2.wmvPvLine[0];
-#else
+#ifndef CCHESS_A3800
+  if (Search.bQuiet) {
+    return;
+  }
   // 12. ŷӦ(Ϊ̨˼Ĳ²ŷ)
+  if (Search.bDebug) {
+    PopEvalCache(eng);
+  }
   if (Search2.wmvPvLine[0] != 0) {
-    PopPvLine();
+    PopPvLine(eng);
     dwMoveStr = MOVE_COORD(Search2.wmvPvLine[0]);
     printf("bestmove %.4s", (const char *) &dwMoveStr);
     if (Search2.wmvPvLine[1] != 0) {
@@ -859,3 +1297,127 @@ void SearchMain(int nDepth) {
   fflush(stdout);
 #endif
 }
+
+#ifndef CCHESS_A3800
+
+// ŷɵĽһֻŷǷϷִŷ
+static int64_t Perft(PositionStruct &pos, int nDepth) {
+  int i, nGenMoves;
+  int64_t llNodes;
+  MoveStruct mvs[MAX_GEN_MOVES];
+  nGenMoves = pos.GenAllMoves(mvs);
+  llNodes = 0;
+  if (nDepth == 1) {
+    for (i = 0; i < nGenMoves; i ++) {
+      if (pos.KingSafe(mvs[i].wmv)) {
+        llNodes ++;
+      }
+    }
+    return llNodes;
+  }
+  for (i = 0; i < nGenMoves; i ++) {
+    if (pos.MakeMove(mvs[i].wmv)) {
+      llNodes += Perft(pos, nDepth - 1);
+      pos.UndoMakeMove();
+    }
+  }
+  return llNodes;
+}
+
+void PopPerft(PositionStruct &pos, int nDepth, bool bDivide) {
+  int i, nGenMoves, nTime;
+  int64_t llTime, llNodes, llMoveNodes;
+  uint32_t dwMoveStr;
+  MoveStruct mvs[MAX_GEN_MOVES];
+  llTime = GetTime();
+  llNodes = 0;
+  nGenMoves = pos.GenAllMoves(mvs);
+  for (i = 0; i < nGenMoves; i ++) {
+    if (nDepth == 1) {
+      llMoveNodes = (pos.KingSafe(mvs[i].wmv) ? 1 : 0);
+    } else if (pos.MakeMove(mvs[i].wmv)) {
+      llMoveNodes = Perft(pos, nDepth - 1);
+      pos.UndoMakeMove();
+    } else {
+      llMoveNodes = 0;
+    }
+    // ֱÿŷĽں
+    if (bDivide && llMoveNodes > 0) {
+      dwMoveStr = MOVE_COORD(mvs[i].wmv);
+      printf("info move %.4s nodes %" FORMAT_I64 "d\n", (const char *) &dwMoveStr, llMoveNodes);
+      fflush(stdout);
+    }
+    llNodes += llMoveNodes;
+  }
+  nTime = (int) (GetTime() - llTime);
+  printf("perft depth %d nodes %" FORMAT_I64 "d time %d nps %" FORMAT_I64 "d\n",
+      nDepth, llNodes, nTime, llNodes * 1000 / MAX(nTime, 1));
+  fflush(stdout);
+}
+
+// ٶȲԵľ棬֡оֺͲо֣췽ͺڷĶ
+static const char *const cszBenchFens[] = {
+  "rnbakabnr/9/1c5c1/p1p1p1p1p/9/9/P1P1P1P1P/1C5C1/9/RNBAKABNR w",
+  "rnbakabr1/9/1c2c1n2/p1p1p2Cp/6p2/2P6/P3P1P1P/1C2B1N2/9/RN1AKABR1 b",
+  "2bakab2/9/1cn1cr3/pCP1p3p/6p2/5C1R1/P3P1P1P/3rB1N2/9/2RAKA3 w",
+  "2baka1nr/9/2C6/p3p1p1p/2b6/6P2/P3c3P/2N3r2/5R3/R1BAKAB2 b",
+  "2b1ka3/4aR3/4b3n/p3p1p1p/3n5/4P1P2/Pc1rc4/1CNNC4/4A1R2/2B1KA1r1 w",
+  "2bk1an2/2n1a1N2/9/p1p1p3p/9/2P6/P2r3rP/3CB2C1/1R1R5/3AKAB2 b",
+  "2b1ka3/2Nc5/3ab1nn1/2C1p3p/P8/2B6/4P3P/Nc7/4A4/3AKC3 w",
+  "2baka3/9/4b1n2/p7C/5Rp2/4c1r2/P7P/2N6/3K5/2BA1A3 w",
+  "2b1ka3/4a4/4b4/1R6N/2n1c4/2R5P/p2rr4/4B4/2N1A4/2BAK4 b",
+  "1C2ka3/2P2r3/3ab4/p3n3p/2b4N1/P5R2/2N5P/8n/4A4/4K4 w",
+  "5a3/4k4/3a5/p2C5/9/2P2p2N/7rP/4B3C/3R5/3AKAB2 w",
+  "4k4/4a1C2/9/8R/r8/2P3P2/9/4B4/9/2BAKA3 w",
+  NULL
+};
+
+const int BENCH_DEPTH = 8;       // ٶȲԵȱʡ
+const int BENCH_HASH_SCALE = 24; // ٶȲԵûС(16M)
+
+/* ٶȲԣڵʵõ̶̡߳Сûȱʡõľ棬
+ * ֻܽйأΪֵ(signature)ĶǷӰ
+ */
+void PopBench(int nDepth) {
+  int i, nTime, nPosTime;
+  int64_t llTime, llPosTime, llNodes, llPosNodes;
+  uint32_t dwMoveStr;
+  EngineStruct *lpeng = new EngineStruct;
+  SearchStruct &Search = lpeng->Search;
+  if (!NewEngine(*lpeng, BENCH_HASH_SCALE)) {
+    delete lpeng;
+    return;
+  }
+  Search.bBatch = Search.bQuiet = true;
+  Search.bUseBook = false;
+  Search.nGoMode = GO_MODE_INFINITY;
+  Search.llNodes = 0;
+  nDepth = (nDepth == 0 ? BENCH_DEPTH : nDepth);
+  llTime = GetTime();
+  llNodes = 0;
+  for (i = 0; cszBenchFens[i] != NULL; i ++) {
+    Search.pos.FromFen(cszBenchFens[i]);
+    BindPos(*lpeng, Search.pos);
+    Search.pos.nDistance = 0;
+    Search.pos.PreEvaluate();
+    Search.nBanMoves = 0;
+    Search.bDraw = Search.bPonder = false;
+    llPosTime = GetTime();
+    SearchMain(*lpeng, nDepth);
+    nPosTime = (int) (GetTime() - llPosTime);
+    llPosNodes = AllNodes(*lpeng);
+    llNodes += llPosNodes;
+    dwMoveStr = MOVE_COORD(Search.mvResult);
+    printf("info bench position %d nodes %" FORMAT_I64 "d time %d bestmove %.4s\n",
+        i + 1, llPosNodes, nPosTime, Search.mvResult == 0 ? "none" : (const char *) &dwMoveStr);
+    fflush(stdout);
+  }
+  nTime = (int) (GetTime() - llTime);
+  DelEngine(*lpeng);
+  delete lpeng;
+  printf("bench depth %d signature %" FORMAT_I64 "d time %d nps %" FORMAT_I64 "d\n",
+      nDepth, llNodes, nTime, llNodes * 1000 / MAX(nTime, 1));
+  fflush(stdout);
+}
+
+#endif
@@ -22,11 +22,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "../base/base.h"
 #include "../base/rc4prng.h"
+#include "pregen.h"
+#include "position.h"
+#include "hash.h"
 #ifndef CCHESS_A3800
   #include "ucci.h"
+  #include "book.h"
 #endif
-#include "pregen.h"
-#include "position.h"
 
 #ifndef SEARCH_H
 #define SEARCH_H
@@ -36,7 +38,11 @@ const int GO_MODE_INFINITY = 0;
 const int GO_MODE_NODES = 1;
 const int GO_MODE_TIMER = 2;
 
-// ǰõȫֱָ
+const int MAX_THREADS = 32; // ̵߳
+const int MAX_MULTI_PV = 16; // Ҫ
+const int INTERRUPT_COUNT = 4096; // ɽж
+
+// ǰõ
 struct SearchStruct {
   PositionStruct pos;                // дľ
   bool bQuit, bPonder, bDraw;        // Ƿյ˳ָ̨˼ģʽģʽ
@@ -44,30 +50,75 @@ struct SearchStruct {
   bool bUseHash, bUseBook;           // ǷʹûüͿֿ
   bool bNullMove, bKnowledge;        // ǷŲüʹþ֪ʶ
   bool bIdle;                        // Ƿ
+  bool bQuiet;                       // ǷκϢ(Ƕʱʹ)
   RC4Struct rc4Random;               // 
-  int nGoMode, nNodes, nCountMask;   // ģʽ
+  int nGoMode, nCountMask;           // ģʽжϼλ
+  int64_t llNodes;                   // ޶Ľ
   int nProperTimer, nMaxTimer;       // ƻʹʱ
   int nRandomMask, nBanMoves;        // λͽ
+  int nMultiPv;                      // Ҫ
   uint16_t wmvBanList[MAX_MOVE_NUM]; // б
-  char szBookFile[1024];             // ֿ
-#ifdef CCHESS_A3800
-  int mvResult;                      // ŷ
-#endif
+  char szBookFile[1024];             // ֿ⣬ֿ÷ֺŷָ
+  int mvResult;                      // ŷûŷʱΪ0
 };
 
-extern SearchStruct Search;
+struct SearchInfoStruct;   // Ϣֻģڲʹ("search.cpp")
+struct SearchThreadStruct; // ߳Ϣֻģڲʹ("search.cpp")
+
+/* ʵԤ۽ṹụ̂߳ʵ֮䲻κοдݣ
+ * һͬʱжɵʵֻֻŷԤ("pregen.h")
+ * ǶʱӦ"Search.bBatch""Search.bQuiet"ʱȡUCCIָҲκϢ
+ * "Search.mvResult"лãUCCI汾ֻһʵ
+ */
+struct EngineStruct {
+  SearchStruct Search;                        // еľ"BuildPos()""BindPos()"
+  PreEvalStruct PreEval;                      // Ԥ۽ṹ
+  PreEvalStructEx PreEvalEx;                  // չľԤ۽ṹ
+  HashTableStruct Hash;                       // û
+#ifndef CCHESS_A3800
+  BookListStruct Books;                       // ֿ⣬"LoadBooks()"ӳ䵽ڴ
+#endif
+  SearchInfoStruct *lpSearch2;                // Ϣ
+  SearchThreadStruct *lpThreads[MAX_THREADS]; // ̣߳0߳
+  int nThreads, nThreadsStarted;              // ߳Ѿ߳
+}; // eng
+
+// þʹʵľԤ۽ṹûıҪ"PreEvaluate()"
+inline void BindPos(EngineStruct &eng, PositionStruct &pos) {
+  pos.lpPreEval = &eng.PreEval;
+  pos.lpPreEvalEx = &eng.PreEvalEx;
+  pos.lpHash = &eng.Hash;
+}
+
+// ʵûС 2^nHashScale ֽڣΪʼ棬Ϊȱʡֵû䲻ʱ"false"
+bool NewEngine(EngineStruct &eng, int nHashScale);
+
+// ͷʵ̡߳ûͿֿ
+void DelEngine(EngineStruct &eng);
 
 #ifndef CCHESS_A3800
 
 // UCCI湹
-void BuildPos(PositionStruct &pos, const UcciCommStruct &UcciComm);
+void BuildPos(EngineStruct &eng, PositionStruct &pos, const UcciCommStruct &UcciComm);
 
 // UCCI֧ - ҶӽľϢ
-void PopLeaf(PositionStruct &pos);
+void PopLeaf(EngineStruct &eng, PositionStruct &pos);
+
+// ߳
+void SetThreads(EngineStruct &eng, int nThreadNum);
+
+// ָ - Ծŷ(perft)ԷֱÿŷĽ
+void PopPerft(PositionStruct &pos, int nDepth, bool bDivide);
+
+// ָ - õһ棬ܽ(Ϊֵ)ʱٶȣΪ0ʱʹȱʡ
+void PopBench(int nDepth);
 
 #endif
 
+// µ֣ûʷ
+void NewGame(EngineStruct &eng);
+
 // 
-void SearchMain(int nDepth);
+void SearchMain(EngineStruct &eng, int nDepth);
 
 #endif
@@ -21,9 +21,98 @@ can be used without restriction.
  * "ucci"ʱͷ"UCCI_COMM_UCCI"һɷ"UCCI_COMM_UNKNOWN"
  * ǰȴǷ룬ûִдָ"Idle()"
  * ("BusyLine()"ֻ˼ʱ)ûʱֱӷ"UCCI_COMM_UNKNOWN"
+ *
+ * ׼ɵ̶߳ȡָŽһѭУϽȡ͡
+ * ˼ʱ"stop""ponderhit"ֱָ߳"UcciBusy"еźţУ
+ * ̲ؼͽָյ"stop"ָҲֹ
  */
 static PipeStruct pipeStd;
 
+const int INPUT_QUEUE_LEN = 16; // еĳȣ2
+
+static char szInputQueue[INPUT_QUEUE_LEN][LINE_INPUT_MAX_CHAR];
+static volatile uint32_t dwInputHead = 0, dwInputTail = 0; // ̴߳Ӷȡ̴߳Ӷβ
+
+UcciBusyStruct UcciBusy;
+
+// ߳ȡһָʱ"false"
+static bool InputLine(char *szLineStr) {
+  int nReadEnd;
+  while (!pipeStd.GetBuffer(szLineStr)) {
+    // һ̫ˣͽض
+    if (pipeStd.nReadEnd == LINE_INPUT_MAX_CHAR) {
+      memcpy(szLineStr, pipeStd.szBuffer, LINE_INPUT_MAX_CHAR - 1);
+      szLineStr[LINE_INPUT_MAX_CHAR - 1] = '\0';
+      pipeStd.szBuffer[0] = pipeStd.szBuffer[LINE_INPUT_MAX_CHAR - 1];
+      pipeStd.nReadEnd = 1;
+      return true;
+    }
+    nReadEnd = pipeStd.nReadEnd;
+    pipeStd.ReadInput();
+    if (pipeStd.nEof != 0 || pipeStd.nReadEnd == nReadEnd) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ̵߳ڣʱ൱յ"quit"ָ
+static void *InputEntry(void *lpParameter) {
+  char szLineStr[LINE_INPUT_MAX_CHAR];
+  volatile bool *lpbStop;
+  bool bEof;
+  bEof = false;
+  while (!bEof) {
+    if (!InputLine(szLineStr)) {
+      strcpy(szLineStr, "quit");
+      bEof = true;
+    }
+    // 1. ˼ʱ"stop""ponderhit"ֱָźţ"quit"ָֹٽ
+    if (UcciBusy.bBusy) {
+      lpbStop = UcciBusy.lpbStop;
+      if (false) {
+      } else if (StrEqv(szLineStr, "stop")) {
+        *lpbStop = true;
+        continue;
+      } else if (StrEqv(szLineStr, "ponderhit draw")) {
+        UcciBusy.bDraw = true;
+        MemFence();
+        UcciBusy.bPonderHit = true;
+        continue;
+      } else if (StrEqv(szLineStr, "ponderhit")) {
+        UcciBusy.bPonderHit = true;
+        continue;
+      } else if (StrEqv(szLineStr, "quit")) {
+        *lpbStop = true;
+      }
+    }
+    // 2. ָŽУʱȴ߳ȡ
+    while (dwInputTail - dwInputHead == INPUT_QUEUE_LEN) {
+      Idle();
+    }
+    strcpy(szInputQueue[dwInputTail & (INPUT_QUEUE_LEN - 1)], szLineStr);
+    MemFence();
+    dwInputTail ++;
+  }
+  return NULL;
+}
+
+bool InputReady(void) {
+  return dwInputHead != dwInputTail;
+}
+
+// ӶȡһָΪʱ"false"
+static bool FetchLine(char *szLineStr) {
+  if (dwInputHead == dwInputTail) {
+    return false;
+  }
+  MemFence();
+  strcpy(szLineStr, szInputQueue[dwInputHead & (INPUT_QUEUE_LEN - 1)]);
+  MemFence();
+  dwInputHead ++;
+  return true;
+}
+
 const int MAX_MOVE_NUM = 1024;
 
 static char szFen[LINE_INPUT_MAX_CHAR];
@@ -59,7 +148,9 @@ static bool ParsePos(UcciCommStruct &UcciComm, char *lp) {
 UcciCommEnum BootLine(void) {
   char szLineStr[LINE_INPUT_MAX_CHAR];
   pipeStd.Open();
-  while (!pipeStd.LineInput(szLineStr)) {
+  UcciBusy.bBusy = false;
+  StartThread(InputEntry, NULL);
+  while (!FetchLine(szLineStr)) {
     Idle();
   }
   if (StrEqv(szLineStr, "ucci")) {
@@ -75,7 +166,7 @@ UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug) {
   int i;
   bool bGoTime;
 
-  while (!pipeStd.LineInput(szLineStr)) {
+  while (!FetchLine(szLineStr)) {
     Idle();
   }
   lp = szLineStr;
@@ -175,7 +266,7 @@ UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug) {
     // (10) "hashsize"ѡ
     } else if (StrEqvSkip(lp, "hashsize ")) {
       UcciComm.Option = UCCI_OPTION_HASHSIZE;
-      UcciComm.nSpin = Str2Digit(lp, 0, 1024);
+      UcciComm.nSpin = Str2Digit(lp, 0, 65536);
 
     // (11) "threads"ѡ
     } else if (StrEqvSkip(lp, "threads ")) {
@@ -279,7 +370,17 @@ UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug) {
     } else if (StrEqv(lp, "newgame")) {
       UcciComm.Option = UCCI_OPTION_NEWGAME;
 
-    // (19) ޷ʶѡ
+    // (19) "hashfile"ѡ
+    } else if (StrEqvSkip(lp, "hashfile ")) {
+      UcciComm.Option = UCCI_OPTION_HASHFILE;
+      UcciComm.szOption = lp;
+
+    // (20) "multipv"ѡ
+    } else if (StrEqvSkip(lp, "multipv ")) {
+      UcciComm.Option = UCCI_OPTION_MULTIPV;
+      UcciComm.nSpin = Str2Digit(lp, 1, 16);
+
+    // (21) ޷ʶѡ
     } else {
       UcciComm.Option = UCCI_OPTION_UNKNOWN;
     }
@@ -316,7 +417,7 @@ UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug) {
       UcciComm.nDepth = Str2Digit(lp, 0, UCCI_MAX_DEPTH);
     } else if (StrEqvSkip(lp, "nodes ")) {
       UcciComm.Go = UCCI_GO_NODES;
-      UcciComm.nDepth = Str2Digit(lp, 0, 2000000000);
+      UcciComm.llNodes = Str2Digit64(lp, 0, (int64_t) 1000000000 * 1000000000);
     } else if (StrEqvSkip(lp, "time ")) {
       UcciComm.nTime = Str2Digit(lp, 0, 2000000000);
       bGoTime = true;
@@ -354,7 +455,21 @@ UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug) {
   } else if (StrEqv(lp, "quit")) {
     return UCCI_COMM_QUIT;
 
-  // 9. ޷ʶָ
+  // 9. "perft <depth> [divide]"ָ
+  } else if (StrEqvSkip(lp, "perft ")) {
+    UcciComm.nTestDepth = Str2Digit(lp, 1, UCCI_MAX_DEPTH);
+    UcciComm.bDivide = StrScan(lp, " divide");
+    return UCCI_COMM_PERFT;
+
+  // 10. "bench [<depth>]"ָע⣺ж"bench "ж"bench"
+  } else if (StrEqvSkip(lp, "bench ")) {
+    UcciComm.nTestDepth = Str2Digit(lp, 1, UCCI_MAX_DEPTH);
+    return UCCI_COMM_BENCH;
+  } else if (StrEqv(lp, "bench")) {
+    UcciComm.nTestDepth = 0;
+    return UCCI_COMM_BENCH;
+
+  // 11. ޷ʶָ
   } else {
     return UCCI_COMM_UNKNOWN;
   }
@@ -363,7 +478,7 @@ UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug) {
 UcciCommEnum BusyLine(UcciCommStruct &UcciComm, bool bDebug) {
   char szLineStr[LINE_INPUT_MAX_CHAR];
   char *lp;
-  if (pipeStd.LineInput(szLineStr)) {
+  if (FetchLine(szLineStr)) {
     if (bDebug) {
       printf("info busyline [%s]\n", szLineStr);
       fflush(stdout);
@@ -20,7 +20,8 @@ const int UCCI_MAX_DEPTH = 32; // UCCI
 enum UcciOptionEnum {
   UCCI_OPTION_UNKNOWN, UCCI_OPTION_BATCH, UCCI_OPTION_DEBUG, UCCI_OPTION_PONDER, UCCI_OPTION_USEHASH, UCCI_OPTION_USEBOOK, UCCI_OPTION_USEEGTB,
   UCCI_OPTION_BOOKFILES, UCCI_OPTION_EGTBPATHS, UCCI_OPTION_HASHSIZE, UCCI_OPTION_THREADS, UCCI_OPTION_PROMOTION,
-  UCCI_OPTION_IDLE, UCCI_OPTION_PRUNING, UCCI_OPTION_KNOWLEDGE, UCCI_OPTION_RANDOMNESS, UCCI_OPTION_STYLE, UCCI_OPTION_NEWGAME
+  UCCI_OPTION_IDLE, UCCI_OPTION_PRUNING, UCCI_OPTION_KNOWLEDGE, UCCI_OPTION_RANDOMNESS, UCCI_OPTION_STYLE, UCCI_OPTION_NEWGAME,
+  UCCI_OPTION_HASHFILE, UCCI_OPTION_MULTIPV
 }; // "setoption"ָѡ
 enum UcciRepetEnum {
   UCCI_REPET_ALWAYSDRAW, UCCI_REPET_CHECKBAN, UCCI_REPET_ASIANRULE, UCCI_REPET_CHINESERULE
@@ -36,13 +37,14 @@ enum UcciGoEnum {
 }; // "go"ָָʱģʽֱ޶ȡ޶ʱƺͼʱ
 enum UcciCommEnum {
   UCCI_COMM_UNKNOWN, UCCI_COMM_UCCI, UCCI_COMM_ISREADY, UCCI_COMM_PONDERHIT, UCCI_COMM_PONDERHIT_DRAW, UCCI_COMM_STOP,
-  UCCI_COMM_SETOPTION, UCCI_COMM_POSITION, UCCI_COMM_BANMOVES, UCCI_COMM_GO, UCCI_COMM_PROBE, UCCI_COMM_QUIT
-}; // UCCIָ
+  UCCI_COMM_SETOPTION, UCCI_COMM_POSITION, UCCI_COMM_BANMOVES, UCCI_COMM_GO, UCCI_COMM_PROBE, UCCI_COMM_QUIT,
+  UCCI_COMM_PERFT, UCCI_COMM_BENCH
+}; // UCCIָͣElephantEyeĲָ
 
 // UCCIָԽͳĽṹ
 union UcciCommStruct {
 
-  /* ɵõϢUCCIָֻ4
+  /* ɵõϢUCCIָֻ5
    *
    * 1. "setoption"ָݵϢʺ"UCCI_COMM_SETOPTION"ָ
    *    "setoption"ָ趨ѡܵϢСѡ͡͡ѡֵ
@@ -86,17 +88,39 @@ union UcciCommStruct {
     bool bPonder;  // ̨˼
     bool bDraw;    // 
     union {
-      int nDepth, nNodes, nTime;
+      int nDepth, nTime;
+      int64_t llNodes;
     }; // ȡʱ
     union {
       int nMovesToGo, nIncrement;
     }; // ޶ʱҪ߶ٲ(ʱ)ò޶ʱӶ(ʱ)
   };
+
+  /* 5. "perft""bench"ָݵϢʺ"UCCI_COMM_PERFT""UCCI_COMM_BENCH"ָ
+   *    "perft"ָԵǰŷ"bench"ָһõľ棬ٶ
+   */
+  struct {
+    int nTestDepth; // ȣ"bench"ָָʱΪ0
+    bool bDivide;   // "perft"ָǷֱÿŷĽ
+  };
 };
 
+// ˼ʱźţֱ߳Ӵ"stop""ponderhit"ָãֻЩ־
+struct UcciBusyStruct {
+  volatile bool bBusy;          // Ƿ˼(ģʽ²)
+  volatile bool *lpbStop;       // յ"stop""quit"ָʱҪõֹźţָ
+  volatile bool bPonderHit;     // յ"ponderhit""ponderhit draw"ָ
+  volatile bool bDraw;          // յ"ponderhit draw"ָ
+};
+
+extern UcciBusyStruct UcciBusy;
+
+// Ƿ߳յδ͵ָ
+bool InputReady(void);
+
 // UCCIָڲͬ
 UcciCommEnum BootLine(void);                                  // UCCIĵһָֻ"ucci"
 UcciCommEnum IdleLine(UcciCommStruct &UcciComm, bool bDebug); // ʱָ
-UcciCommEnum BusyLine(UcciCommStruct &UcciComm, bool bDebug); // ˼ʱָֻ"stop""ponderhit""probe"
+UcciCommEnum BusyLine(UcciCommStruct &UcciComm, bool bDebug); // ˼ʱָֻ"isready""stop""ponderhit""probe""quit"
 
 #endif
@@ -37,6 +37,7 @@ int main(void) {
   char sz[LINE_INPUT_MAX_CHAR], sz2[LINE_INPUT_MAX_CHAR];
   char szTime[LINE_INPUT_MAX_CHAR], szInc[LINE_INPUT_MAX_CHAR], szBookFile[LINE_INPUT_MAX_CHAR];
   BookStruct mvsBook[MAX_GEN_MOVES];
+  static BookListStruct Books;
   RC4Struct rc4;
   PipeStruct pipeConsole, pipeEngine;
   PositionStruct pos;
@@ -47,6 +48,7 @@ int main(void) {
   pipeConsole.Open();
   pipeEngine.Open(sz);
   PreGenInit();
+  LoadBooks(Books, szBookFile);
   rc4.InitRand();
   pos.FromFen(cszStartFen);
 
@@ -116,11 +118,8 @@ int main(void) {
           // "setoption bookfiles ..."
         } else if (strncmp(sz, "setoption bookfiles ", 20) == 0) {
           lp = sz + 20;
-          if (AbsolutePath(lp)) {
-            strcpy(szBookFile, lp);
-          } else {
-            LocatePath(szBookFile, lp);
-          }
+          strcpy(szBookFile, lp);
+          LoadBooks(Books, szBookFile);
           continue;
 
           // "setoption hashsize ..." -> "setoption name Hash value ..."
@@ -174,7 +173,7 @@ int main(void) {
         // search book
         if (bUseBook) {
           // a. get all moves for this position
-          nLen = GetBookMoves(pos, szBookFile, mvsBook);
+          nLen = GetBookMoves(pos, Books, mvsBook);
 
           if (nLen > 0) {
             vl = 0;
@@ -200,7 +199,7 @@ int main(void) {
               dwMoveStr = MOVE_COORD(mvsBook[i].wmv);
               printf("bestmove %.4s", (const char *) &dwMoveStr);
               // d. get ponder move (next move with max weight)
-              nLen = GetBookMoves(pos, szBookFile, mvsBook);
+              nLen = GetBookMoves(pos, Books, mvsBook);
               pos.UndoMakeMove();
               if (nLen > 0) {
                 dwMoveStr = MOVE_COORD(mvsBook[0].wmv);